@@ -0,0 +1,93 @@
+// Results on the heap or on an arena: a table of records parsed into
+// nested vectors (a vector of rows, each a vector of fields) and
+// literal strings, with the default HeapResults, with ArenaResults on
+// each stream's own arena, and with one arena released and reused
+// across parses. Reports time per parse and the number of heap
+// allocations it made.
+
+#include "cppeg.hpp"
+#include "harness.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+namespace {
+
+std::atomic<std::size_t> allocations{0};
+
+} // namespace
+
+void *operator new(std::size_t n) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(n ? n : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+using namespace cppeg;
+
+namespace {
+
+// "transaction-record: 12,ab,345,...\n"
+auto table_grammar() {
+    auto field = span(+~NotCharClass<AnyChar<',', '\n'>>{});
+    auto row   = Literal("transaction-record:") + ~Char<' '> + field +
+               *(~Char<','> + field) + ~Char<'\n'>;
+    return *row;
+}
+
+template<typename Stream>
+std::size_t run(std::string const &text, Arena *arena) {
+    Stream S(text);
+    if (arena) {
+        arena->release();
+        S.context().set_arena(*arena);
+    }
+    auto rule = table_grammar();
+    auto   ret  = rule.parse(S);
+    return ret ? ret->size() : 0;
+}
+
+template<typename Stream>
+void bench(std::string_view name, std::string const &text,
+           Arena *arena = nullptr) {
+    auto rows   = run<Stream>(text, arena);
+    auto before = allocations.load(std::memory_order_relaxed);
+    cppeg_bench::do_not_optimize(run<Stream>(text, arena));
+    auto allocs = allocations.load(std::memory_order_relaxed) - before;
+
+    auto ns = cppeg_bench::best_ns_per_call(
+        [&] { cppeg_bench::do_not_optimize(run<Stream>(text, arena)); });
+    cppeg_bench::report(name, ns, rows, "row");
+    std::printf("%56s %12zu allocs/parse\n", "", allocs);
+}
+
+} // namespace
+
+int main() {
+    std::string text;
+    unsigned    seed = 12345;
+    for (int i = 0; i < 20000; ++i) {
+        text += "transaction-record: ";
+        for (int f = 0; f < 8; ++f) {
+            seed = seed * 1103515245u + 12345u;
+            text += (f ? "," : "") + std::to_string(seed >> 20);
+        }
+        text += '\n';
+    }
+
+    using Heap    = InputStream<char, NoSkip>;
+    using OnArena  = InputStream<char, NoSkip, ArenaResults>;
+
+    Arena reused;
+    bench<Heap>("table, HeapResults", text);
+    bench<OnArena>("table, ArenaResults, arena per stream", text);
+    bench<OnArena>("table, ArenaResults, one arena reused", text, &reused);
+}
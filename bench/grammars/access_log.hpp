@@ -0,0 +1,255 @@
+#ifndef CPPEG_BENCH_GRAMMARS_ACCESS_LOG_HPP
+#define CPPEG_BENCH_GRAMMARS_ACCESS_LOG_HPP
+
+#include "common.hpp"
+#include "cppeg.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+
+/**
+ * Web server access logs in the Combined Log Format:
+ *
+ *   203.0.113.7 - alice [10/Oct/2023:13:55:36 +0000] "GET /a HTTP/1.1"
+ *       200 2326 "https://example.com/" "Mozilla/5.0 (X11)"
+ *
+ * one record per line. The checksum is the number of lines plus the
+ * sum of all status codes and response sizes ('-' counting as 0).
+ */
+namespace cppeg_bench::access_log {
+
+inline std::string generate(std::size_t bytes) {
+    static char const *const users[]   = {"-", "-", "-", "alice", "bob"};
+    static char const *const methods[] = {"GET", "GET", "GET", "POST",
+                                          "PUT", "DELETE", "HEAD"};
+    static char const *const paths[]   = {
+        "/", "/index.html", "/api/v1/items?page=2&sort=desc",
+        "/static/css/main.3f2a9c.css", "/images/logo.png",
+        "/login", "/api/v1/users/12345/settings"};
+    static char const *const statuses[] = {"200", "200", "200", "304",
+                                           "404", "500", "301"};
+    static char const *const referers[] = {
+        "-", "https://example.com/", "https://www.google.com/search?q=cppeg"};
+    static char const *const agents[] = {
+        "Mozilla/5.0 (X11; Linux x86_64; rv:109.0) Gecko/20100101 "
+        "Firefox/118.0",
+        "curl/8.4.0",
+        "Mozilla/5.0 (Macintosh; Intel Mac OS X 10_15_7) "
+        "AppleWebKit/605.1.15 (KHTML, like Gecko) Version/17.0 "
+        "Safari/605.1.15"};
+
+    Lcg         rng;
+    std::string out;
+    out.reserve(bytes + 512);
+    while (out.size() < bytes) {
+        for (int i = 0; i < 4; ++i) {
+            out += i ? "." : "";
+            out += std::to_string(rng(256));
+        }
+        out += " - ";
+        out += rng.pick(users);
+        out += " [";
+        out += std::to_string(1 + rng(28));
+        out += "/Oct/2023:";
+        out += std::to_string(10 + rng(14));
+        out += ":";
+        out += std::to_string(10 + rng(50));
+        out += ":";
+        out += std::to_string(10 + rng(50));
+        out += " +0000] \"";
+        out += rng.pick(methods);
+        out += ' ';
+        out += rng.pick(paths);
+        out += " HTTP/1.1\" ";
+        out += rng.pick(statuses);
+        out += ' ';
+        if (rng(5) == 0) {
+            out += '-';
+        } else {
+            out += std::to_string(rng(100000));
+        }
+        out += " \"";
+        out += rng.pick(referers);
+        out += "\" \"";
+        out += rng.pick(agents);
+        out += "\"\n";
+    }
+    return out;
+}
+
+class Grammar {
+public:
+    using Stream = cppeg::InputStream<char, cppeg::NoSkip>;
+
+    Grammar() {
+        using namespace cppeg;
+
+        using digit = CharRng<'0', '9'>;
+
+        auto sp     = ~Char<' '>;
+        auto octet  = ~repeat<1, 3>(~digit{});
+        auto ip     = octet + ~Char<'.'> + octet + ~Char<'.'> + octet +
+                  ~Char<'.'> + octet;
+        auto token  = +~NotCharClass<AnyChar<' ', '\n'>>{};
+        auto date   = ~Char<'['> + +~NotCharClass<AnyChar<']', '\n'>>{} +
+                    ~Char<']'>;
+        auto method = ~"GET"_lit | ~"POST"_lit | ~"PUT"_lit |
+                      ~"DELETE"_lit | ~"HEAD"_lit;
+        auto request = ~Char<'"'> + ~method + sp +
+                       ~+~NotCharClass<AnyChar<' ', '"', '\n'>>{} + sp +
+                       ~"HTTP/"_lit + ~digit{} + ~Char<'.'> + ~digit{} +
+                       ~Char<'"'>;
+        auto to_number = [](auto &v) { return to_u64(*v); };
+        auto zero      = [](auto &) { return std::uint64_t{0}; };
+        auto count_line = [this](auto &v) {
+            auto &[code, bytes] = *v;
+            m_total += 1 + code + std::get<std::uint64_t>(bytes);
+        };
+
+        auto status = span(repeat<3>(~digit{}))[to_number];
+        auto size   = span(+~digit{})[to_number] | Char<'-'>[zero];
+        auto quoted = ~Char<'"'> + ~*~NotCharClass<AnyChar<'"', '\n'>>{} +
+                      ~Char<'"'>;
+
+        auto line = (~ip + sp + ~token + sp + ~token + sp + ~date + sp +
+                     ~request + sp + status + sp + size + sp + ~quoted + sp +
+                     ~quoted + ~Char<'\n'>)[count_line];
+
+        m_document.define(*~line);
+    }
+
+    Grammar(Grammar const &) = delete;
+    Grammar &operator=(Grammar const &) = delete;
+
+    std::optional<std::uint64_t> parse(std::string_view text) {
+        Stream S(text);
+        m_total = 0;
+        if (!m_document.parse(S) || S.distance_to_end() != 0) {
+            return std::nullopt;
+        }
+        return m_total;
+    }
+
+private:
+    cppeg::RuleRef<std::size_t, Stream> m_document;
+    std::uint64_t                       m_total{0};
+};
+
+namespace detail {
+
+class Baseline {
+public:
+    Baseline(std::string_view text)
+        : p(text.data()), end(text.data() + text.size()) {}
+
+    std::optional<std::uint64_t> document() {
+        std::uint64_t total = 0;
+        while (p != end) {
+            std::uint64_t code, bytes;
+            if (!(ip() && eat(' ') && token() && eat(' ') && token() &&
+                  eat(' ') && date() && eat(' ') && request() && eat(' ') &&
+                  number(3, 3, code) && eat(' ') && size(bytes) &&
+                  eat(' ') && quoted() && eat(' ') && quoted() &&
+                  eat('\n'))) {
+                return std::nullopt;
+            }
+            total += 1 + code + bytes;
+        }
+        return total;
+    }
+
+private:
+    bool eat(char c) {
+        if (p != end && *p == c) {
+            ++p;
+            return true;
+        }
+        return false;
+    }
+
+    bool literal(std::string_view s) {
+        if (static_cast<std::size_t>(end - p) >= s.size() &&
+            std::string_view(p, s.size()) == s) {
+            p += s.size();
+            return true;
+        }
+        return false;
+    }
+
+    // Between min and max digits.
+    bool number(int min, int max, std::uint64_t &v) {
+        v     = 0;
+        int n = 0;
+        while (n < max && p != end && is_digit(*p)) {
+            v = v * 10 + static_cast<std::uint64_t>(*p++ - '0');
+            ++n;
+        }
+        return n >= min;
+    }
+
+    bool ip() {
+        std::uint64_t v;
+        return number(1, 3, v) && eat('.') && number(1, 3, v) && eat('.') &&
+               number(1, 3, v) && eat('.') && number(1, 3, v);
+    }
+
+    // Up to (not including) one of Stops; fails if empty.
+    template<char... Stops>
+    bool until() {
+        char const *start = p;
+        while (p != end && ((*p != Stops) && ...)) {
+            ++p;
+        }
+        return p != start;
+    }
+
+    bool token() { return until<' ', '\n'>(); }
+
+    bool date() { return eat('[') && until<']', '\n'>() && eat(']'); }
+
+    bool request() {
+        if (!eat('"')) {
+            return false;
+        }
+        if (!(literal("GET") || literal("POST") || literal("PUT") ||
+              literal("DELETE") || literal("HEAD"))) {
+            return false;
+        }
+        std::uint64_t v;
+        return eat(' ') && until<' ', '"', '\n'>() && eat(' ') &&
+               literal("HTTP/") && number(1, 1, v) && eat('.') &&
+               number(1, 1, v) && eat('"');
+    }
+
+    bool size(std::uint64_t &bytes) {
+        if (eat('-')) {
+            bytes = 0;
+            return true;
+        }
+        return number(1, 20, bytes);
+    }
+
+    bool quoted() {
+        if (!eat('"')) {
+            return false;
+        }
+        until<'"', '\n'>();
+        return eat('"');
+    }
+
+    char const *p;
+    char const *end;
+};
+
+} // namespace detail
+
+inline std::optional<std::uint64_t> baseline(std::string_view text) {
+    return detail::Baseline(text).document();
+}
+
+} // namespace cppeg_bench::access_log
+
+#endif
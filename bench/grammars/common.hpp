@@ -0,0 +1,58 @@
+#ifndef CPPEG_BENCH_GRAMMARS_COMMON_HPP
+#define CPPEG_BENCH_GRAMMARS_COMMON_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * Shared by the grammars of the cppeg_bench suite. Each grammar
+ * header provides, in its own namespace:
+ *
+ *   std::string generate(std::size_t bytes);   // at least `bytes` of input
+ *   class Grammar { std::optional<std::uint64_t> parse(std::string_view); };
+ *   std::optional<std::uint64_t> baseline(std::string_view);
+ *
+ * Grammar is written with cppeg, baseline by hand as plain recursive
+ * descent over a char pointer. Both return the same checksum of what
+ * they parsed (counts, sizes, values), or nullopt if the input is not
+ * in the language, so the suite can check they did the same work.
+ */
+namespace cppeg_bench {
+
+// Deterministic input generation: the same bytes on every run.
+class Lcg {
+public:
+    explicit Lcg(std::uint32_t seed = 12345) : m_state(seed) {}
+
+    // Uniform-ish in [0, n).
+    std::uint32_t operator()(std::uint32_t n) {
+        m_state = m_state * 1103515245u + 12345u;
+        return (m_state >> 8) % n;
+    }
+
+    template<typename T, std::size_t N>
+    T const &pick(T const (&items)[N]) {
+        return items[(*this)(N)];
+    }
+
+private:
+    std::uint32_t m_state;
+};
+
+// Decimal digits to a number, wrapping on overflow. Callers have
+// already checked the digits.
+inline std::uint64_t to_u64(std::string_view digits) {
+    std::uint64_t v = 0;
+    for (char c : digits) {
+        v = v * 10 + static_cast<std::uint64_t>(c - '0');
+    }
+    return v;
+}
+
+inline bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+} // namespace cppeg_bench
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef CPPEG_BENCH_GRAMMARS_CSV_HPP
+#define CPPEG_BENCH_GRAMMARS_CSV_HPP
+
+#include "common.hpp"
+#include "cppeg.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+
+/**
+ * RFC 4180 style CSV, every record ending in '\n':
+ *
+ *   record := field (',' field)* '\n'
+ *   field  := '"' ([^"] | '""')* '"' | [^,"\n]*
+ *
+ * The checksum is the number of fields plus their total size (quoted
+ * fields counted without the enclosing quotes, escapes as written).
+ */
+namespace cppeg_bench::csv {
+
+inline std::string generate(std::size_t bytes) {
+    static char const *const words[] = {
+        "alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf",
+        "hotel", "india", "juliett", "kilo", "lima", "mike", "november"};
+
+    Lcg         rng;
+    std::string out;
+    out.reserve(bytes + 256);
+    while (out.size() < bytes) {
+        out += std::to_string(rng(1000000)); // id
+        out += ',';
+        out += rng.pick(words);
+        out += ',';
+        if (rng(3) == 0) { // quoted, with a separator and an escape
+            out += '"';
+            out += rng.pick(words);
+            out += ", \"\"";
+            out += rng.pick(words);
+            out += "\"\"\"";
+        } else {
+            out += rng.pick(words);
+            out += ' ';
+            out += rng.pick(words);
+        }
+        out += ',';
+        out += std::to_string(rng(100000));
+        out += '.';
+        out += std::to_string(rng(100));
+        out += ",,"; // an empty field
+        out += rng.pick(words);
+        out += '\n';
+    }
+    return out;
+}
+
+class Grammar {
+public:
+    using Stream = cppeg::InputStream<char, cppeg::NoSkip>;
+
+    Grammar() {
+        using namespace cppeg;
+
+        auto quoted =
+            ~Char<'"'> +
+            span(*~(NotCharClass<CharRule<'"'>>{} | "\"\""_lit)) +
+            ~Char<'"'>;
+        auto unquoted = span(*~NotCharClass<AnyChar<',', '"', '\n'>>{});
+
+        auto count_field = [this](auto &v) {
+            std::visit(
+                [this](auto const &x) {
+                    using X = std::decay_t<decltype(x)>;
+                    if constexpr (std::is_same_v<X, std::string_view>) {
+                        m_total += 1 + x.size();
+                    } else if constexpr (!std::is_same_v<X, std::monostate>) {
+                        m_total += 1 + std::get<0>(x).size();
+                    }
+                },
+                v);
+        };
+
+        auto field  = (quoted | unquoted)[count_field];
+        auto record = field + *~(Char<','> + field) + ~Char<'\n'>;
+
+        m_record.define(~record);
+    }
+
+    Grammar(Grammar const &) = delete;
+    Grammar &operator=(Grammar const &) = delete;
+
+    std::optional<std::uint64_t> parse(std::string_view text) {
+        Stream S(text);
+        m_total = 0;
+        // One record at a time: at the end of input an empty field
+        // would match (and be counted) before the record fails.
+        while (S.distance_to_end() != 0) {
+            if (!m_record.parse(S)) {
+                return std::nullopt;
+            }
+        }
+        return m_total;
+    }
+
+private:
+    cppeg::RuleRef<cppeg::null_parse, Stream> m_record;
+    std::uint64_t                             m_total{0};
+};
+
+inline std::optional<std::uint64_t> baseline(std::string_view text) {
+    char const   *p     = text.data();
+    char const   *end   = p + text.size();
+    std::uint64_t total = 0;
+
+    while (p != end) {
+        while (true) { // one field per iteration
+            if (*p == '"') {
+                char const *start = ++p;
+                while (true) {
+                    if (p == end) {
+                        return std::nullopt;
+                    }
+                    if (*p == '"') {
+                        if (end - p >= 2 && p[1] == '"') {
+                            p += 2;
+                            continue;
+                        }
+                        break;
+                    }
+                    ++p;
+                }
+                total += 1 + static_cast<std::uint64_t>(p - start);
+                ++p;
+            } else {
+                char const *start = p;
+                while (p != end && *p != ',' && *p != '"' && *p != '\n') {
+                    ++p;
+                }
+                total += 1 + static_cast<std::uint64_t>(p - start);
+            }
+
+            if (p != end && *p == ',') {
+                ++p;
+            } else {
+                break;
+            }
+        }
+        if (p == end || *p != '\n') {
+            return std::nullopt;
+        }
+        ++p;
+    }
+    return total;
+}
+
+} // namespace cppeg_bench::csv
+
+#endif
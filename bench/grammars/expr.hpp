@@ -0,0 +1,223 @@
+#ifndef CPPEG_BENCH_GRAMMARS_EXPR_HPP
+#define CPPEG_BENCH_GRAMMARS_EXPR_HPP
+
+#include "common.hpp"
+#include "cppeg.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <variant>
+
+/**
+ * Arithmetic statements, evaluated while parsing:
+ *
+ *   statement := sum ';'
+ *   sum       := term (('+' | '-') term)*
+ *   term      := factor ('*' factor)*
+ *   factor    := number | '(' sum ')'
+ *
+ * Whitespace is skipped by the stream. Arithmetic wraps (uint64), so
+ * every input has a value; the checksum is the sum of all statements.
+ */
+namespace cppeg_bench::expr {
+
+namespace detail {
+
+inline void sum(Lcg &rng, std::string &out, int depth);
+
+inline void factor(Lcg &rng, std::string &out, int depth) {
+    if (depth > 0 && rng(4) == 0) {
+        out += '(';
+        sum(rng, out, depth - 1);
+        out += ')';
+    } else {
+        out += std::to_string(rng(100000));
+    }
+}
+
+inline void term(Lcg &rng, std::string &out, int depth) {
+    factor(rng, out, depth);
+    for (auto n = rng(3); n > 0; --n) {
+        out += " * ";
+        factor(rng, out, depth);
+    }
+}
+
+inline void sum(Lcg &rng, std::string &out, int depth) {
+    term(rng, out, depth);
+    for (auto n = rng(4); n > 0; --n) {
+        out += rng(2) ? " + " : " - ";
+        term(rng, out, depth);
+    }
+}
+
+} // namespace detail
+
+inline std::string generate(std::size_t bytes) {
+    Lcg         rng;
+    std::string out;
+    out.reserve(bytes + 256);
+    while (out.size() < bytes) {
+        detail::sum(rng, out, 3);
+        out += ";\n";
+    }
+    return out;
+}
+
+class Grammar {
+public:
+    using Stream = cppeg::InputStream<char, cppeg::SkipWhitespace>;
+
+    Grammar() {
+        using namespace cppeg;
+
+        auto to_number = [](auto &v) { return to_u64(*v); };
+        auto first     = [](auto &v) { return std::get<0>(*v); };
+        auto value_of  = [](auto &v) { return std::get<std::uint64_t>(v); };
+        auto product   = [](auto &v) {
+            auto &[acc, rest] = *v;
+            for (auto &f : rest) {
+                acc *= std::get<0>(f);
+            }
+            return acc;
+        };
+        auto sum_of = [](auto &v) {
+            auto &[acc, rest] = *v;
+            for (auto &[op, t] : rest) {
+                acc = op == '+' ? acc + t : acc - t;
+            }
+            return acc;
+        };
+        auto add_to_total = [this](auto &v) { m_total += std::get<0>(*v); };
+
+        auto number = span(+~CharRng<'0', '9'>{})[to_number];
+        auto paren  = (~Char<'('> + m_sum + ~Char<')'>)[first];
+        auto factor = (number | paren)[value_of];
+        auto term   = (factor + *(~Char<'*'> + factor))[product];
+        auto sum    = (term + *(AnyChar<'+', '-'>{} + term))[sum_of];
+
+        auto &top      = m_sum.define(sum);
+        auto statement = (top + ~Char<';'>)[add_to_total];
+        m_document.define(*~statement);
+    }
+
+    Grammar(Grammar const &) = delete;
+    Grammar &operator=(Grammar const &) = delete;
+
+    std::optional<std::uint64_t> parse(std::string_view text) {
+        Stream S(text);
+        m_total = 0;
+        if (!m_document.parse(S)) {
+            return std::nullopt;
+        }
+        S.peekChar(); // trailing whitespace
+        if (S.distance_to_end() != 0) {
+            return std::nullopt;
+        }
+        return m_total;
+    }
+
+private:
+    cppeg::RuleRef<std::uint64_t, Stream> m_sum;
+    cppeg::RuleRef<std::size_t, Stream>   m_document;
+    std::uint64_t                         m_total{0};
+};
+
+namespace detail {
+
+class Baseline {
+public:
+    Baseline(std::string_view text)
+        : p(text.data()), end(text.data() + text.size()) {}
+
+    std::optional<std::uint64_t> document() {
+        std::uint64_t total = 0;
+        while (skip_ws(), p != end) {
+            auto v = sum();
+            if (!v || !eat(';')) {
+                return std::nullopt;
+            }
+            total += *v;
+        }
+        return total;
+    }
+
+private:
+    void skip_ws() {
+        while (p != end && (*p == ' ' || (*p >= '\t' && *p <= '\r'))) {
+            ++p;
+        }
+    }
+
+    bool eat(char c) {
+        skip_ws();
+        if (p != end && *p == c) {
+            ++p;
+            return true;
+        }
+        return false;
+    }
+
+    std::optional<std::uint64_t> factor() {
+        skip_ws();
+        if (p != end && is_digit(*p)) {
+            std::uint64_t v = 0;
+            while (p != end && is_digit(*p)) {
+                v = v * 10 + static_cast<std::uint64_t>(*p++ - '0');
+            }
+            return v;
+        }
+        if (eat('(')) {
+            auto v = sum();
+            if (v && eat(')')) {
+                return v;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::optional<std::uint64_t> term() {
+        auto acc = factor();
+        while (acc && eat('*')) {
+            auto f = factor();
+            if (!f) {
+                return std::nullopt;
+            }
+            *acc *= *f;
+        }
+        return acc;
+    }
+
+    std::optional<std::uint64_t> sum() {
+        auto acc = term();
+        while (acc) {
+            skip_ws();
+            if (p == end || (*p != '+' && *p != '-')) {
+                break;
+            }
+            char op = *p++;
+            auto t  = term();
+            if (!t) {
+                return std::nullopt;
+            }
+            *acc = op == '+' ? *acc + *t : *acc - *t;
+        }
+        return acc;
+    }
+
+    char const *p;
+    char const *end;
+};
+
+} // namespace detail
+
+inline std::optional<std::uint64_t> baseline(std::string_view text) {
+    return detail::Baseline(text).document();
+}
+
+} // namespace cppeg_bench::expr
+
+#endif
@@ -0,0 +1,177 @@
+#ifndef CPPEG_BENCH_GRAMMARS_INI_HPP
+#define CPPEG_BENCH_GRAMMARS_INI_HPP
+
+#include "common.hpp"
+#include "cppeg.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/**
+ * INI files, line by line:
+ *
+ *   line    := section | comment | pair | blank
+ *   section := '[' name ']' '\n'
+ *   comment := (';' | '#') [^\n]* '\n'
+ *   pair    := key '=' [^\n]* '\n'
+ *
+ * with blanks and tabs allowed around names, keys and '='. The
+ * checksum is the number of sections and pairs plus the total size
+ * of section names and values (values as written, up to the newline).
+ */
+namespace cppeg_bench::ini {
+
+inline std::string generate(std::size_t bytes) {
+    static char const *const names[] = {
+        "server", "database", "cache.primary", "cache.replica", "logging",
+        "auth",   "feature-flags", "paths"};
+    static char const *const keys[] = {
+        "host", "port", "timeout_ms", "user", "enabled", "level",
+        "path", "max_connections", "retry.count", "name"};
+    static char const *const values[] = {
+        "localhost", "5432", "true", "/var/lib/data/store", "30000",
+        "\"quoted value with spaces\"", "debug", "0.75", ""};
+
+    Lcg         rng;
+    std::string out;
+    out.reserve(bytes + 256);
+    while (out.size() < bytes) {
+        out += '[';
+        out += rng.pick(names);
+        out += "]\n";
+        for (auto n = 1 + rng(12); n > 0; --n) {
+            switch (rng(8)) {
+            case 0: out += "; a comment about the next setting\n"; break;
+            case 1: out += "\n"; break;
+            case 2: out += "\t"; [[fallthrough]];
+            default:
+                out += rng.pick(keys);
+                out += rng(2) ? " = " : "=";
+                out += rng.pick(values);
+                out += '\n';
+                break;
+            }
+        }
+        out += '\n';
+    }
+    return out;
+}
+
+class Grammar {
+public:
+    using Stream = cppeg::InputStream<char, cppeg::NoSkip>;
+
+    Grammar() {
+        using namespace cppeg;
+
+        using name_char = CharClass<CharRng<'a', 'z'>, CharRng<'A', 'Z'>,
+                                    CharRng<'0', '9'>, AnyChar<'_', '.', '-'>>;
+
+        auto blanks  = ~*~AnyChar<' ', '\t'>{};
+        auto rest    = *~NotCharClass<CharRule<'\n'>>{};
+        auto newline = ~Char<'\n'>;
+
+        // sections and pairs both carry one string_view
+        auto count = [this](auto &v) {
+            m_total += 1 + std::get<0>(*v).size();
+        };
+
+        auto section = (~Char<'['> + blanks + span(+~name_char{}) + blanks +
+                        ~Char<']'> + blanks + newline)[count];
+        auto comment = ~(AnyChar<';', '#'>{} + rest) + newline;
+        auto pair    = (blanks + ~+~name_char{} + blanks + ~Char<'='> +
+                     blanks + span(rest) + newline)[count];
+        auto blank = blanks + newline;
+
+        m_document.define(*~(section | comment | pair | blank));
+    }
+
+    Grammar(Grammar const &) = delete;
+    Grammar &operator=(Grammar const &) = delete;
+
+    std::optional<std::uint64_t> parse(std::string_view text) {
+        Stream S(text);
+        m_total = 0;
+        if (!m_document.parse(S) || S.distance_to_end() != 0) {
+            return std::nullopt;
+        }
+        return m_total;
+    }
+
+private:
+    cppeg::RuleRef<std::size_t, Stream> m_document;
+    std::uint64_t                       m_total{0};
+};
+
+namespace detail {
+
+inline bool is_name_char(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || is_digit(c) ||
+           c == '_' || c == '.' || c == '-';
+}
+
+} // namespace detail
+
+inline std::optional<std::uint64_t> baseline(std::string_view text) {
+    char const   *p     = text.data();
+    char const   *end   = p + text.size();
+    std::uint64_t total = 0;
+
+    auto skip_blanks = [&] {
+        while (p != end && (*p == ' ' || *p == '\t')) {
+            ++p;
+        }
+    };
+    auto to_eol = [&] {
+        while (p != end && *p != '\n') {
+            ++p;
+        }
+    };
+
+    while (p != end) {
+        if (*p == '[') {
+            ++p;
+            skip_blanks();
+            char const *start = p;
+            while (p != end && detail::is_name_char(*p)) {
+                ++p;
+            }
+            if (p == start) {
+                return std::nullopt;
+            }
+            total += 1 + static_cast<std::uint64_t>(p - start);
+            skip_blanks();
+            if (p == end || *p++ != ']') {
+                return std::nullopt;
+            }
+            skip_blanks();
+        } else if (*p == ';' || *p == '#') {
+            to_eol();
+        } else {
+            skip_blanks();
+            if (p != end && detail::is_name_char(*p)) {
+                while (p != end && detail::is_name_char(*p)) {
+                    ++p;
+                }
+                skip_blanks();
+                if (p == end || *p++ != '=') {
+                    return std::nullopt;
+                }
+                skip_blanks();
+                char const *start = p;
+                to_eol();
+                total += 1 + static_cast<std::uint64_t>(p - start);
+            }
+        }
+        if (p == end || *p++ != '\n') {
+            return std::nullopt;
+        }
+    }
+    return total;
+}
+
+} // namespace cppeg_bench::ini
+
+#endif
@@ -0,0 +1,339 @@
+#ifndef CPPEG_BENCH_GRAMMARS_JSON_HPP
+#define CPPEG_BENCH_GRAMMARS_JSON_HPP
+
+#include "common.hpp"
+#include "cppeg.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/**
+ * JSON (RFC 8259), validated without building a DOM:
+ *
+ *   value  := object | array | string | number | true | false | null
+ *   object := '{' (string ':' value (',' string ':' value)*)? '}'
+ *   array  := '[' (value (',' value)*)? ']'
+ *
+ * Whitespace is matched explicitly, since strings must keep theirs.
+ * The checksum is the number of values plus the size of all strings
+ * (keys included, quotes excluded).
+ */
+namespace cppeg_bench::json {
+
+namespace detail {
+
+inline void value(Lcg &rng, std::string &out, int depth);
+
+inline void string(Lcg &rng, std::string &out) {
+    static char const *const words[] = {
+        "id",    "name",  "tags",      "score", "active",   "parent",
+        "x",     "items", "caf\\u00e9", "line\\nbreak", "\\\"quoted\\\"",
+        "a much longer string value, with punctuation: and spaces"};
+    out += '"';
+    out += rng.pick(words);
+    out += '"';
+}
+
+inline void number(Lcg &rng, std::string &out) {
+    if (rng(4) == 0) {
+        out += '-';
+    }
+    out += std::to_string(rng(1000000));
+    if (rng(2)) {
+        out += '.';
+        out += std::to_string(rng(1000));
+    }
+    if (rng(8) == 0) {
+        out += "e+";
+        out += std::to_string(rng(30));
+    }
+}
+
+inline void object(Lcg &rng, std::string &out, int depth) {
+    out += '{';
+    for (auto n = rng(6), i = 0u; i < n; ++i) {
+        out += i ? ", " : "";
+        string(rng, out);
+        out += ": ";
+        value(rng, out, depth - 1);
+    }
+    out += '}';
+}
+
+inline void array(Lcg &rng, std::string &out, int depth) {
+    out += '[';
+    for (auto n = rng(6), i = 0u; i < n; ++i) {
+        out += i ? ", " : "";
+        value(rng, out, depth - 1);
+    }
+    out += ']';
+}
+
+inline void value(Lcg &rng, std::string &out, int depth) {
+    switch (depth > 0 ? rng(8) : 2 + rng(6)) {
+    case 0: object(rng, out, depth); break;
+    case 1: array(rng, out, depth); break;
+    case 2:
+    case 3: string(rng, out); break;
+    case 4:
+    case 5: number(rng, out); break;
+    case 6: out += rng(2) ? "true" : "false"; break;
+    default: out += "null"; break;
+    }
+}
+
+} // namespace detail
+
+// One array of records, one record per line.
+inline std::string generate(std::size_t bytes) {
+    Lcg         rng;
+    std::string out;
+    out.reserve(bytes + 4096);
+    out += "[\n";
+    while (out.size() < bytes) {
+        out += out.size() > 2 ? ",\n  " : "  ";
+        detail::object(rng, out, 4);
+    }
+    out += "\n]\n";
+    return out;
+}
+
+class Grammar {
+public:
+    using Stream = cppeg::InputStream<char, cppeg::NoSkip>;
+
+    Grammar() {
+        using namespace cppeg;
+
+        auto ws = ~*~AnyChar<' ', '\t', '\n', '\r'>{};
+        auto digits = +~CharRng<'0', '9'>{};
+        auto opt    = [](auto const &r) { return ~repeat<0, 1>(~r); };
+
+        auto escape = Char<'\\'> + AnyChar<'"', '\\', '/', 'b', 'f', 'n',
+                                           'r', 't', 'u'>{};
+        auto count_string = [this](auto &v) {
+            m_total += std::get<0>(*v).size();
+        };
+        auto count_value = [this](auto &) { ++m_total; };
+
+        auto string =
+            (~Char<'"'> +
+             span(*~(NotCharClass<AnyChar<'"', '\\'>>{} | escape)) +
+             ~Char<'"'>)[count_string];
+
+        auto number =
+            opt(Char<'-'>) +
+            ~(Char<'0'> | (CharRng<'1', '9'>{} + ~*~CharRng<'0', '9'>{})) +
+            opt(Char<'.'> + digits) +
+            opt(AnyChar<'e', 'E'>{} + opt(AnyChar<'+', '-'>{}) + digits);
+
+        auto member = And(string, ws, ~Char<':'>, ws, m_value, ws);
+        auto object = ~Char<'{'> + ws +
+                      opt(member + *~(~Char<','> + ws + ~member)) +
+                      ~Char<'}'>;
+
+        auto element = m_value + ws;
+        auto array   = ~Char<'['> + ws +
+                     opt(element + *~(~Char<','> + ws + ~element)) +
+                     ~Char<']'>;
+
+        auto value = (~object | ~array | string | ~number | ~"true"_lit |
+                      ~"false"_lit | ~"null"_lit)[count_value];
+        auto &top = m_value.define(value);
+        m_document.define(ws + top + ws);
+    }
+
+    Grammar(Grammar const &) = delete;
+    Grammar &operator=(Grammar const &) = delete;
+
+    std::optional<std::uint64_t> parse(std::string_view text) {
+        Stream S(text);
+        m_total = 0;
+        if (!m_document.parse(S) || S.distance_to_end() != 0) {
+            return std::nullopt;
+        }
+        return m_total;
+    }
+
+private:
+    cppeg::RuleRef<cppeg::null_parse, Stream> m_value;
+    cppeg::RuleRef<std::tuple<>, Stream>      m_document;
+    std::uint64_t                             m_total{0};
+};
+
+namespace detail {
+
+class Baseline {
+public:
+    Baseline(std::string_view text)
+        : p(text.data()), end(text.data() + text.size()) {}
+
+    std::optional<std::uint64_t> document() {
+        skip_ws();
+        if (!value()) {
+            return std::nullopt;
+        }
+        skip_ws();
+        if (p != end) {
+            return std::nullopt;
+        }
+        return total;
+    }
+
+private:
+    void skip_ws() {
+        while (p != end &&
+               (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+            ++p;
+        }
+    }
+
+    bool eat(char c) {
+        if (p != end && *p == c) {
+            ++p;
+            return true;
+        }
+        return false;
+    }
+
+    bool literal(std::string_view s) {
+        if (static_cast<std::size_t>(end - p) >= s.size() &&
+            std::string_view(p, s.size()) == s) {
+            p += s.size();
+            return true;
+        }
+        return false;
+    }
+
+    bool digits() {
+        char const *start = p;
+        while (p != end && is_digit(*p)) {
+            ++p;
+        }
+        return p != start;
+    }
+
+    bool string() {
+        if (!eat('"')) {
+            return false;
+        }
+        char const *start = p;
+        while (p != end && *p != '"') {
+            if (*p == '\\') {
+                if (end - p < 2) {
+                    return false;
+                }
+                switch (p[1]) {
+                case '"': case '\\': case '/': case 'b': case 'f':
+                case 'n': case 'r': case 't': case 'u': break;
+                default: return false;
+                }
+                p += 2;
+            } else {
+                ++p;
+            }
+        }
+        if (p == end) {
+            return false;
+        }
+        total += static_cast<std::uint64_t>(p - start);
+        ++p;
+        return true;
+    }
+
+    bool number() {
+        eat('-');
+        if (!eat('0')) {
+            if (p == end || *p < '1' || *p > '9') {
+                return false;
+            }
+            digits();
+        }
+        if (p != end && *p == '.' && end - p >= 2 && is_digit(p[1])) {
+            ++p;
+            digits();
+        }
+        if (p != end && (*p == 'e' || *p == 'E')) {
+            char const *e = p++;
+            if (p != end && (*p == '+' || *p == '-')) {
+                ++p;
+            }
+            if (!digits()) {
+                p = e;
+            }
+        }
+        return true;
+    }
+
+    bool object() {
+        skip_ws();
+        if (eat('}')) {
+            return true;
+        }
+        do {
+            skip_ws();
+            if (!string()) {
+                return false;
+            }
+            skip_ws();
+            if (!eat(':')) {
+                return false;
+            }
+            skip_ws();
+            if (!value()) {
+                return false;
+            }
+            skip_ws();
+        } while (eat(','));
+        return eat('}');
+    }
+
+    bool array() {
+        skip_ws();
+        if (eat(']')) {
+            return true;
+        }
+        do {
+            skip_ws();
+            if (!value()) {
+                return false;
+            }
+            skip_ws();
+        } while (eat(','));
+        return eat(']');
+    }
+
+    bool value() {
+        if (p == end) {
+            return false;
+        }
+        bool ok;
+        switch (*p) {
+        case '{': ++p; ok = object(); break;
+        case '[': ++p; ok = array(); break;
+        case '"': ok = string(); break;
+        case 't': ok = literal("true"); break;
+        case 'f': ok = literal("false"); break;
+        case 'n': ok = literal("null"); break;
+        default: ok = number(); break;
+        }
+        total += ok;
+        return ok;
+    }
+
+    char const   *p;
+    char const   *end;
+    std::uint64_t total{0};
+};
+
+} // namespace detail
+
+inline std::optional<std::uint64_t> baseline(std::string_view text) {
+    return detail::Baseline(text).document();
+}
+
+} // namespace cppeg_bench::json
+
+#endif
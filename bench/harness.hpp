@@ -0,0 +1,254 @@
+#ifndef CPPEG_BENCH_HARNESS_HPP
+#define CPPEG_BENCH_HARNESS_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <string_view>
+
+#if __has_include(<sys/resource.h>)
+#include <sys/resource.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/perf_event.h>)
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define CPPEG_BENCH_HAVE_PERF_EVENTS 1
+#endif
+
+/**
+ * Minimal timing harness shared by the benchmark executables.
+ * No external dependency: each benchmark is a callable that is run
+ * repeatedly, and the best of several timed batches is reported.
+ */
+namespace cppeg_bench {
+
+// Keep the optimizer from discarding benchmark results.
+template<typename T>
+inline void do_not_optimize(T const &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Best wall-clock time (nanoseconds) of a single call to f(),
+// taken over `batches` batches of `calls_per_batch` calls.
+template<typename F>
+double best_ns_per_call(F &&f, int calls_per_batch = 10, int batches = 5) {
+    using clock = std::chrono::steady_clock;
+    double best = std::numeric_limits<double>::max();
+    for (int b = 0; b < batches; ++b) {
+        auto start = clock::now();
+        for (int i = 0; i < calls_per_batch; ++i) {
+            f();
+        }
+        std::chrono::duration<double, std::nano> dt = clock::now() - start;
+        best = std::min(best, dt.count() / calls_per_batch);
+    }
+    return best;
+}
+
+// One line of output: ns per call, plus the same figure divided
+// by the number of `unit`s (bytes, rules, ...) processed per call.
+inline void report(std::string_view name, double ns_per_call,
+                   double units_per_call, std::string_view unit) {
+    std::printf("%-56.*s %12.1f ns/call %10.3f ns/%.*s\n",
+                static_cast<int>(name.size()), name.data(), ns_per_call,
+                ns_per_call / units_per_call, static_cast<int>(unit.size()),
+                unit.data());
+}
+
+// Peak resident set size of the process so far, in bytes (0 if
+// unknown). On Linux this is VmHWM, which reset_peak_rss() can lower
+// back to the current size, so the peak of one phase can be measured.
+inline std::size_t peak_rss_bytes() {
+#if defined(__linux__)
+    if (auto f = std::fopen("/proc/self/status", "r")) {
+        char        line[256];
+        std::size_t kb = 0;
+        while (std::fgets(line, sizeof line, f)) {
+            if (std::strncmp(line, "VmHWM:", 6) == 0) {
+                kb = std::strtoull(line + 6, nullptr, 10);
+                break;
+            }
+        }
+        std::fclose(f);
+        if (kb) {
+            return kb * 1024;
+        }
+    }
+#endif
+#if __has_include(<sys/resource.h>)
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(__APPLE__)
+        return static_cast<std::size_t>(usage.ru_maxrss); // bytes
+#else
+        return static_cast<std::size_t>(usage.ru_maxrss) * 1024; // KB
+#endif
+    }
+#endif
+    return 0;
+}
+
+// Returns false where the peak cannot be reset; peak_rss_bytes() is
+// then the peak of the whole run.
+inline bool reset_peak_rss() {
+#if defined(__linux__)
+    if (auto f = std::fopen("/proc/self/clear_refs", "w")) {
+        bool ok = std::fputs("5", f) >= 0;
+        return std::fclose(f) == 0 && ok;
+    }
+#endif
+    return false;
+}
+
+/**
+ * Hardware event counts (Linux perf_event_open) over a stretch of
+ * code, for this thread, user space only:
+ *
+ *   PerfCounters perf;
+ *   perf.start();
+ *   parse();
+ *   perf.stop();
+ *   auto misses = perf.count(PerfCounters::branch_misses);
+ *
+ * Each event is opened on its own, so one the CPU or VM does not
+ * expose does not take the others with it. In containers the syscall
+ * is often refused altogether (seccomp, perf_event_paranoid); then
+ * nothing is available and error() says why. Counts are scaled when
+ * the kernel had to multiplex the counters.
+ */
+class PerfCounters {
+public:
+    enum Event {
+        cycles,
+        instructions,
+        branch_misses,
+        l1d_misses, // L1 data cache read misses
+        llc_misses, // last-level cache misses
+        num_events
+    };
+
+    static constexpr char const *names[num_events] = {
+        "cycles", "instr", "br-miss", "L1d-miss", "LLC-miss"};
+
+    PerfCounters() {
+#ifdef CPPEG_BENCH_HAVE_PERF_EVENTS
+        auto cache = [](std::uint64_t id, std::uint64_t op,
+                        std::uint64_t result) {
+            return id | (op << 8) | (result << 16);
+        };
+        open(cycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        open(instructions, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        open(branch_misses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        open(l1d_misses, PERF_TYPE_HW_CACHE,
+             cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                   PERF_COUNT_HW_CACHE_RESULT_MISS));
+        open(llc_misses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+#else
+        m_error = "perf_event_open is not available on this platform";
+#endif
+    }
+
+    PerfCounters(PerfCounters const &) = delete;
+    PerfCounters &operator=(PerfCounters const &) = delete;
+
+    ~PerfCounters() {
+#ifdef CPPEG_BENCH_HAVE_PERF_EVENTS
+        for (int fd : m_fds) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+#endif
+    }
+
+    bool available(Event e) const { return m_fds[e] >= 0; }
+
+    bool any_available() const {
+        return std::any_of(std::begin(m_fds), std::end(m_fds),
+                           [](int fd) { return fd >= 0; });
+    }
+
+    // Why the first unavailable event could not be opened.
+    char const *error() const { return m_error; }
+
+    void start() {
+#ifdef CPPEG_BENCH_HAVE_PERF_EVENTS
+        for (int fd : m_fds) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+
+    void stop() {
+#ifdef CPPEG_BENCH_HAVE_PERF_EVENTS
+        for (int fd : m_fds) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+#endif
+    }
+
+    // Count between the last start() and stop(), or nullopt if the
+    // event is unavailable (or was never scheduled on the CPU).
+    std::optional<double> count(Event e) const {
+#ifdef CPPEG_BENCH_HAVE_PERF_EVENTS
+        // With PERF_FORMAT_TOTAL_TIME_ENABLED | _RUNNING
+        struct {
+            std::uint64_t value, enabled, running;
+        } r;
+        if (m_fds[e] >= 0 && ::read(m_fds[e], &r, sizeof r) == sizeof r &&
+            r.running > 0) {
+            return static_cast<double>(r.value) * r.enabled / r.running;
+        }
+#endif
+        (void)e;
+        return std::nullopt;
+    }
+
+private:
+#ifdef CPPEG_BENCH_HAVE_PERF_EVENTS
+    void open(Event e, std::uint32_t type, std::uint64_t config) {
+        perf_event_attr attr{};
+        attr.size           = sizeof attr;
+        attr.type           = type;
+        attr.config         = config;
+        attr.disabled       = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                           PERF_FORMAT_TOTAL_TIME_RUNNING;
+        m_fds[e] = static_cast<int>(
+            syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (m_fds[e] < 0 && !m_error) {
+            m_error = errno == EACCES || errno == EPERM
+                          ? "perf_event_open not permitted (see "
+                            "/proc/sys/kernel/perf_event_paranoid)"
+                          : errno == ENOENT || errno == EOPNOTSUPP
+                                ? "event not supported by this CPU or VM"
+                                : "perf_event_open failed";
+        }
+    }
+#endif
+
+    int         m_fds[num_events] = {-1, -1, -1, -1, -1};
+    char const *m_error           = nullptr;
+};
+
+} // namespace cppeg_bench
+
+#endif
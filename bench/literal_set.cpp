@@ -0,0 +1,67 @@
+// Alternations of literals: an OrRule comparing each Literal in turn
+// (built with Or(), which does not fold) against the LiteralSet that
+// `|` folds them into, on a pseudo-random sequence of SQL keywords.
+
+#include "cppeg.hpp"
+#include "harness.hpp"
+
+#include <string>
+
+using namespace cppeg;
+
+namespace {
+
+char const *const keywords[] = {
+    "select", "insert", "update", "delete", "from",   "where",  "group",
+    "order",  "by",     "having", "limit",  "offset", "join",   "inner",
+    "outer",  "left",   "right",  "on",     "as",     "and",    "or",
+    "not",    "null",   "values", "into",   "set",    "create", "table",
+    "drop",   "alter",  "index",  "union"};
+
+template<typename R>
+std::size_t run(std::string const &text, R rule) {
+    InputStream<char, NoSkip> S(text);
+    std::size_t               n = 0;
+    while (parse_success(rule.parse(S))) {
+        ++n;
+    }
+    cppeg_bench::do_not_optimize(n);
+    return n;
+}
+
+template<typename R>
+void bench(std::string_view name, std::string const &text, R rule) {
+    auto n  = run(text, rule);
+    auto ns = cppeg_bench::best_ns_per_call([&] { run(text, rule); });
+    cppeg_bench::report(name, ns, n, "keyword");
+}
+
+template<std::size_t... Is>
+auto sequential(std::index_sequence<Is...>) {
+    return Or(Literal(keywords[Is])...);
+}
+
+template<std::size_t... Is>
+auto folded(std::index_sequence<Is...>) {
+    return (Literal(keywords[Is]) | ...);
+}
+
+} // namespace
+
+int main() {
+    constexpr std::size_t n = std::size(keywords);
+
+    std::string text;
+    unsigned    seed = 12345;
+    for (int i = 0; i < 50000; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        text += keywords[(seed >> 16) % n];
+    }
+
+    // LiteralSet's default mode is ordered choice, so both split the
+    // text into the same keywords.
+    bench("32 keywords, OrRule of Literal", text,
+          sequential(std::make_index_sequence<n>{}));
+    bench("32 keywords, LiteralSet", text,
+          folded(std::make_index_sequence<n>{}));
+}
@@ -0,0 +1,72 @@
+// Numbers: the Int and Float rules against the usual way of reading
+// them before they existed, a span() of digit rules converted by a
+// callback, on comma-separated lists of integers and decimals.
+
+#include "cppeg.hpp"
+#include "harness.hpp"
+
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+using namespace cppeg;
+
+namespace {
+
+template<typename R>
+std::size_t run(std::string const &text, R rule) {
+    InputStream<char, NoSkip> S(text);
+    std::size_t               n = 0;
+    while (parse_success(rule.parse(S))) {
+        ++n;
+    }
+    cppeg_bench::do_not_optimize(n);
+    return n;
+}
+
+template<typename R>
+void bench(std::string_view name, std::string const &text, R rule) {
+    auto n  = run(text, rule);
+    auto ns = cppeg_bench::best_ns_per_call([&] { run(text, rule); });
+    cppeg_bench::report(name, ns, n, "number");
+}
+
+} // namespace
+
+int main() {
+    std::string ints, decimals;
+    unsigned    seed = 12345;
+    for (int i = 0; i < 50000; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        ints += std::to_string(seed % 1000000000u) + ',';
+        decimals += std::to_string((seed >> 8) % 100000) + '.' +
+                    std::to_string(seed % 1000) + ',';
+    }
+
+    auto digits = +~CharRng<'0', '9'>{};
+    auto comma  = ~Char<','>;
+
+    std::uint64_t sink = 0;
+
+    auto to_int = [&](auto &v) {
+        auto          s = std::get<0>(*v);
+        std::uint64_t x = 0;
+        std::from_chars(s.data(), s.data() + s.size(), x);
+        sink += x;
+    };
+    bench("integers, span + from_chars", ints,
+          (span(digits) + comma)[to_int]);
+    bench("integers, Int<uint64_t>", ints,
+          Int<std::uint64_t> + comma);
+
+    auto to_double = [&](auto &v) {
+        std::string s(std::get<0>(*v));
+        sink += static_cast<std::uint64_t>(std::strtod(s.c_str(), nullptr));
+    };
+    bench("decimals, span + strtod", decimals,
+          (span(digits + ~Char<'.'> + digits) + comma)[to_double]);
+    bench("decimals, Float<double>", decimals, Float<double> + comma);
+
+    cppeg_bench::do_not_optimize(sink);
+}
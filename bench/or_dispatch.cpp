@@ -0,0 +1,119 @@
+// First-char dispatch in OrRule.
+//
+// A keyword alternation: each keyword is an alternative, and the input
+// is a pseudo-random sequence of them. With dispatch only the
+// alternative(s) starting with the next char are tried; the same rules
+// wrapped so their first sets are unknown are tried in order, as
+// OrRule used to. Plain keywords and statements reject on their first
+// char anyway, so OrRule only dispatches for the memoized ones, where
+// each rejected alternative costs a memo table lookup.
+
+#include "cppeg.hpp"
+#include "harness.hpp"
+
+#include <string>
+
+using namespace cppeg;
+
+namespace {
+
+// Forwards to R but keeps the default (unknown) first set.
+template<typename R>
+struct Opaque : public Rule<Opaque<R>> {
+    Opaque(R r = R{}) : rule(r) {}
+
+    static constexpr bool restores_on_failure = true;
+
+    template<typename Stream>
+    auto parse_impl(Stream &in) {
+        return rule.parse(in);
+    }
+
+    R rule;
+};
+
+template<typename Or>
+std::size_t run(std::string const &text, Or rule) {
+    InputStream<char, NoSkip> S(text);
+    std::size_t               n = 0;
+    while (parse_success(rule.parse(S))) {
+        ++n;
+    }
+    cppeg_bench::do_not_optimize(n);
+    return n;
+}
+
+template<typename Or>
+void bench(std::string_view name, std::string const &text, Or rule) {
+    auto n  = run(text, rule);
+    auto ns = cppeg_bench::best_ns_per_call([&] { run(text, rule); });
+    cppeg_bench::report(name, ns, n, "token");
+}
+
+template<typename R>
+auto opaque(R r) {
+    return Opaque<R>(r);
+}
+
+// keyword "(" name ")" ";"
+template<typename Kw>
+auto stmt() {
+    return Kw{} + Char<'('> + CharRng<'a', 'z'>{} + Char<')'> + Char<';'>;
+}
+
+} // namespace
+
+int main() {
+    using If       = decltype("if"_lit);
+    using Else     = decltype("else"_lit);
+    using While    = decltype("while"_lit);
+    using For      = decltype("for"_lit);
+    using Return   = decltype("return"_lit);
+    using Break    = decltype("break"_lit);
+    using Continue = decltype("continue"_lit);
+    using Switch   = decltype("switch"_lit);
+
+    // Keywords in a fixed pseudo-random order, so that which
+    // alternative matches is not predictable from the previous ones.
+    char const *names[] = {"if",     "else",  "while",    "for",
+                           "return", "break", "continue", "switch"};
+    std::string  keywords, statements;
+    unsigned     seed = 12345;
+    for (int i = 0; i < 80000; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        auto kw = names[(seed >> 16) % 8];
+        keywords += kw;
+        statements += kw;
+        statements += "(x);";
+    }
+
+    bench("keywords, ordered trial", keywords,
+          Or(~Opaque<If>{}, ~Opaque<Else>{}, ~Opaque<While>{},
+             ~Opaque<For>{}, ~Opaque<Return>{}, ~Opaque<Break>{},
+             ~Opaque<Continue>{}, ~Opaque<Switch>{}));
+    bench("keywords, first sets known", keywords,
+          Or(~If{}, ~Else{}, ~While{}, ~For{}, ~Return{}, ~Break{},
+             ~Continue{}, ~Switch{}));
+
+    bench("statements, ordered trial", statements,
+          Or(~opaque(stmt<If>()), ~opaque(stmt<Else>()),
+             ~opaque(stmt<While>()), ~opaque(stmt<For>()),
+             ~opaque(stmt<Return>()), ~opaque(stmt<Break>()),
+             ~opaque(stmt<Continue>()), ~opaque(stmt<Switch>())));
+    bench("statements, first sets known", statements,
+          Or(~stmt<If>(), ~stmt<Else>(), ~stmt<While>(), ~stmt<For>(),
+             ~stmt<Return>(), ~stmt<Break>(), ~stmt<Continue>(),
+             ~stmt<Switch>()));
+
+    bench("memoized statements, ordered trial", statements,
+          Or(~opaque(memo(stmt<If>())), ~opaque(memo(stmt<Else>())),
+             ~opaque(memo(stmt<While>())), ~opaque(memo(stmt<For>())),
+             ~opaque(memo(stmt<Return>())), ~opaque(memo(stmt<Break>())),
+             ~opaque(memo(stmt<Continue>())),
+             ~opaque(memo(stmt<Switch>()))));
+    bench("memoized statements, first sets known", statements,
+          Or(~memo(stmt<If>()), ~memo(stmt<Else>()), ~memo(stmt<While>()),
+             ~memo(stmt<For>()), ~memo(stmt<Return>()),
+             ~memo(stmt<Break>()), ~memo(stmt<Continue>()),
+             ~memo(stmt<Switch>())));
+}
@@ -0,0 +1,74 @@
+// Packrat memoization on a grammar with exponential backtracking.
+//
+// Level n is `Or(p + 'x', p)` with p = level n-1, so on an input where
+// every 'x' is missing each level parses p twice: 2^n attempts in
+// total. Memoizing p at every level makes it n, either with the
+// unbounded PackratRule or the fixed-size MemoRule table. (Results are
+// discarded to keep the result types small.) Each level also names p
+// twice in its type, so the type doubles per level too; depth stops at
+// 12, where unoptimized builds still compile it.
+
+#include "cppeg.hpp"
+#include "harness.hpp"
+
+#include <string>
+
+using namespace cppeg;
+
+namespace {
+
+enum class Memo { none, packrat, table };
+
+template<int N, Memo M>
+auto level() {
+    if constexpr (N == 0) {
+        return Char<'a'>;
+    } else {
+        auto sub = level<N - 1, M>();
+        if constexpr (M == Memo::packrat) {
+            auto p = packrat(sub);
+            return Or(~(p + Char<'x'>), ~p);
+        } else if constexpr (M == Memo::table) {
+            auto p = memo(sub);
+            return Or(~(p + Char<'x'>), ~p);
+        } else {
+            return Or(~(sub + Char<'x'>), ~sub);
+        }
+    }
+}
+
+template<int N>
+void bench_depth() {
+    std::string text = "a";
+
+    auto plain = level<N, Memo::none>();
+    auto pr    = level<N, Memo::packrat>();
+    auto table = level<N, Memo::table>();
+
+    auto plain_ns = cppeg_bench::best_ns_per_call([&] {
+        InputStream<> S(text);
+        cppeg_bench::do_not_optimize(parse_success(plain.parse(S)));
+    });
+    auto packrat_ns = cppeg_bench::best_ns_per_call([&] {
+        InputStream<> S(text);
+        cppeg_bench::do_not_optimize(parse_success(pr.parse(S)));
+    });
+    auto table_ns = cppeg_bench::best_ns_per_call([&] {
+        InputStream<> S(text);
+        S.context().set_memo_capacity(64);
+        cppeg_bench::do_not_optimize(parse_success(table.parse(S)));
+    });
+
+    auto depth = " (depth " + std::to_string(N) + ")";
+    cppeg_bench::report("backtracking" + depth, plain_ns, N, "level");
+    cppeg_bench::report("packrat" + depth, packrat_ns, N, "level");
+    cppeg_bench::report("memo table" + depth, table_ns, N, "level");
+}
+
+} // namespace
+
+int main() {
+    bench_depth<4>();
+    bench_depth<8>();
+    bench_depth<12>();
+}
@@ -0,0 +1,93 @@
+// parse_records: one access log line grammar over 64 MB of
+// newline-delimited records, on 1, 2, 4, ... threads up to the core
+// count, against a plain sequential loop with a single InputStream.
+
+#include "grammars/access_log.hpp"
+#include "harness.hpp"
+
+#include <cstdint>
+#include <string>
+#include <thread>
+
+using namespace cppeg;
+
+namespace {
+
+using Stream = InputStream<char, NoSkip>;
+
+// A line of the access_log suite grammar, without its newline,
+// returning the status code plus the response size.
+auto line_grammar() {
+    using digit = CharRng<'0', '9'>;
+
+    auto sp     = ~Char<' '>;
+    auto octet  = ~repeat<1, 3>(~digit{});
+    auto ip     = octet + ~Char<'.'> + octet + ~Char<'.'> + octet +
+              ~Char<'.'> + octet;
+    auto token  = +~NotCharClass<AnyChar<' ', '\n'>>{};
+    auto date   = ~Char<'['> + +~NotCharClass<AnyChar<']', '\n'>>{} +
+                ~Char<']'>;
+    auto request = ~Char<'"'> + ~+~NotCharClass<AnyChar<'"', '\n'>>{} +
+                   ~Char<'"'>;
+    auto quoted  = ~Char<'"'> + ~*~NotCharClass<AnyChar<'"', '\n'>>{} +
+                  ~Char<'"'>;
+    auto zero  = [](auto &) { return std::uint64_t{0}; };
+    auto total = [](auto &v) {
+        auto &[code, bytes] = *v;
+        return code + std::get<std::uint64_t>(bytes);
+    };
+
+    auto size = Int<std::uint64_t> | Char<'-'>[zero];
+    return (~ip + sp + ~token + sp + ~token + sp + ~date + sp + ~request +
+            sp + Int<std::uint64_t> + sp + size + sp + ~quoted + sp +
+            ~quoted)[total];
+}
+
+} // namespace
+
+int main() {
+    auto const text  = cppeg_bench::access_log::generate(std::size_t{64} << 20);
+    auto       rule  = line_grammar();
+    double     bytes = static_cast<double>(text.size());
+
+    auto sequential = [&] {
+        Stream        S(text);
+        std::uint64_t sum = 0;
+        while (S.distance_to_end() != 0) {
+            auto v = rule.parse(S);
+            if (!v || S.getChar() != '\n') {
+                return std::uint64_t{0};
+            }
+            sum += 1 + *v;
+        }
+        return sum;
+    };
+    auto expected = sequential();
+    auto ns       = cppeg_bench::best_ns_per_call(
+        [&] { cppeg_bench::do_not_optimize(sequential()); }, 1, 3);
+    cppeg_bench::report("access_log, one InputStream", ns, bytes, "byte");
+    double base = ns;
+
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned threads = 1; threads <= cores; threads *= 2) {
+        auto run = [&] {
+            std::uint64_t sum  = 0;
+            auto          sink = [&](std::string_view, auto &&v) {
+                sum += 1 + v.value_or(~std::uint64_t{0});
+            };
+            parse_records<Stream>(rule, text, sink, '\n', threads);
+            return sum;
+        };
+        if (run() != expected) {
+            std::fprintf(stderr, "parse_records disagrees with the "
+                                 "sequential parse\n");
+            return 1;
+        }
+        auto t  = cppeg_bench::best_ns_per_call(
+            [&] { cppeg_bench::do_not_optimize(run()); }, 1, 3);
+        auto name = "access_log, parse_records, " +
+                    std::to_string(threads) + " thread(s)";
+        cppeg_bench::report(name, t, bytes, "byte");
+        std::printf("%56s %12.2fx\n", "speedup", base / t);
+    }
+}
@@ -0,0 +1,81 @@
+// Per-rule overhead of Rule::parse backtracking checkpoints.
+//
+// Compares the stack-local checkpoints used by InputStream against a
+// stream that keeps them in a std::vector, the way InputStream used to
+// (push/pop/pop_reset on m_pos_stack). Single-char rules rewind
+// themselves and take no checkpoint, so only sequences are measured;
+// each match is one checkpoint.
+
+#include "cppeg.hpp"
+#include "harness.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace cppeg;
+
+namespace {
+
+class VectorCheckpointStream : public InputStream<char> {
+public:
+    using InputStream<char>::InputStream;
+
+    checkpoint_type checkpoint() {
+        m_pos_stack.push_back(get_pos());
+        return m_pos_stack.back();
+    }
+
+    void commit(checkpoint_type) { m_pos_stack.pop_back(); }
+
+    void restore(checkpoint_type) {
+        InputStream<char>::restore(m_pos_stack.back());
+        m_pos_stack.pop_back();
+    }
+
+private:
+    std::vector<std::size_t> m_pos_stack;
+};
+
+// Number of sequences matched. Each is one checkpoint and one rule per
+// char, plus the sequence itself.
+template<typename Stream, typename R>
+std::size_t run(std::string const &text, R rule) {
+    Stream      S(text);
+    std::size_t n = 0;
+    while (parse_success(rule.parse(S))) {
+        ++n;
+    }
+    cppeg_bench::do_not_optimize(n);
+    return n;
+}
+
+template<typename R>
+void compare(std::string_view name, std::string const &text, R rule,
+             double rules_per_match) {
+    auto matches = run<InputStream<char>>(text, rule);
+    auto rules   = matches * rules_per_match;
+
+    auto stack_ns = cppeg_bench::best_ns_per_call(
+        [&] { run<InputStream<char>>(text, rule); });
+    auto vector_ns = cppeg_bench::best_ns_per_call(
+        [&] { run<VectorCheckpointStream>(text, rule); });
+
+    cppeg_bench::report(std::string(name) + " [stack checkpoint]", stack_ns,
+                        rules, "rule");
+    cppeg_bench::report(std::string(name) + " [vector checkpoint]",
+                        vector_ns, rules, "rule");
+}
+
+} // namespace
+
+int main() {
+    std::string as(1 << 20, 'a');
+    compare("Char<'a'> + Char<'a'>", as, Char<'a'> + Char<'a'>, 3);
+
+    std::string abc;
+    for (int i = 0; i < (1 << 18); ++i) {
+        abc += "abc";
+    }
+    compare("Char<'a'> + Char<'b'> + Char<'c'>", abc,
+            Char<'a'> + Char<'b'> + Char<'c'>, 4);
+}
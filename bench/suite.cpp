@@ -0,0 +1,269 @@
+// cppeg_bench: throughput of realistic grammars.
+//
+// Each grammar in grammars/ is parsed from generated input of growing
+// size (1 KB up to --max-size, 32x per step), once with cppeg and once
+// with a hand-written recursive-descent parser of the same language,
+// whose difference is the cost of the abstraction. Both must agree on
+// a checksum of what they parsed. Reported per run: throughput,
+// ns/byte, heap allocations per parse and the peak RSS while parsing
+// (input included).
+//
+//   cppeg_bench [--max-size N[K|M|G]] [--perf] [grammar...]
+//
+// The default maximum is 32M; --max-size 1G adds the 1 GB inputs,
+// which need a few GB of memory and some patience. --perf adds a line
+// of hardware counts per byte (cycles, instructions, branch misses,
+// L1d and LLC misses), where the kernel lets us read them.
+
+#include "grammars/access_log.hpp"
+#include "grammars/csv.hpp"
+#include "grammars/expr.hpp"
+#include "grammars/ini.hpp"
+#include "grammars/json.hpp"
+#include "harness.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+std::atomic<std::size_t> allocations{0};
+
+} // namespace
+
+// Count every heap allocation of the process. The array, aligned and
+// nothrow forms all end up here or in the aligned overload below.
+void *operator new(std::size_t n) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(n ? n : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t n, std::align_val_t al) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    auto a    = std::max(static_cast<std::size_t>(al), sizeof(void *));
+    auto size = (std::max<std::size_t>(n, 1) + a - 1) / a * a;
+    if (void *p = std::aligned_alloc(a, size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+struct Options {
+    std::size_t              max_size = std::size_t{32} << 20;
+    std::vector<std::string> grammars; // empty: all of them
+    bool                     perf = false;
+};
+
+std::optional<std::size_t> parse_size(std::string_view s) {
+    std::size_t v = 0, i = 0;
+    for (; i < s.size() && s[i] >= '0' && s[i] <= '9'; ++i) {
+        v = v * 10 + static_cast<std::size_t>(s[i] - '0');
+    }
+    if (i == 0 || i + 1 < s.size()) {
+        return std::nullopt;
+    }
+    if (i < s.size()) {
+        switch (s[i]) {
+        case 'K': case 'k': v <<= 10; break;
+        case 'M': case 'm': v <<= 20; break;
+        case 'G': case 'g': v <<= 30; break;
+        default: return std::nullopt;
+        }
+    }
+    return v;
+}
+
+std::string size_label(std::size_t bytes) {
+    if (bytes >= (std::size_t{1} << 30)) {
+        return std::to_string(bytes >> 30) + " GB";
+    }
+    if (bytes >= (std::size_t{1} << 20)) {
+        return std::to_string(bytes >> 20) + " MB";
+    }
+    return std::to_string(bytes >> 10) + " KB";
+}
+
+void report(std::string_view grammar, std::string_view parser,
+            std::size_t size, std::size_t bytes, double ns,
+            std::size_t allocs, std::size_t peak_rss) {
+    std::printf("%-10.*s %-9.*s %7s %10.1f MB/s %8.3f ns/byte %12zu allocs "
+                "%9.1f MB RSS\n",
+                static_cast<int>(grammar.size()), grammar.data(),
+                static_cast<int>(parser.size()), parser.data(),
+                size_label(size).c_str(), bytes / ns * 1e3, ns / bytes,
+                allocs, peak_rss / double(1 << 20));
+}
+
+// Hardware counts of `calls` parses, per byte parsed.
+void report_perf(cppeg_bench::PerfCounters const &perf, double bytes) {
+    using cppeg_bench::PerfCounters;
+    std::printf("%29s", "");
+    for (int e = 0; e < PerfCounters::num_events; ++e) {
+        auto n = perf.count(static_cast<PerfCounters::Event>(e));
+        if (n) {
+            std::printf(" %8.4f", *n / bytes);
+        } else {
+            std::printf(" %8s", "n/a");
+        }
+        std::printf(" %s/B", PerfCounters::names[e]);
+    }
+    auto cycles = perf.count(PerfCounters::cycles);
+    auto instr  = perf.count(PerfCounters::instructions);
+    if (cycles && instr && *cycles > 0) {
+        std::printf("  IPC %.2f", *instr / *cycles);
+    }
+    std::printf("\n");
+}
+
+// Times parse(text) and reports it, with hardware counts if perf is
+// given. Returns its checksum, or nullopt if the input was rejected.
+template<typename Parse>
+std::optional<std::uint64_t> measure(std::string_view grammar,
+                                     std::string_view parser,
+                                     std::size_t size, std::string const &text,
+                                     Parse &&parse,
+                                     cppeg_bench::PerfCounters *perf) {
+    cppeg_bench::reset_peak_rss();
+
+    // Warm-up, which also builds any lazily initialized state, so the
+    // allocation count below is that of a steady-state parse.
+    auto checksum = parse(text);
+    if (!checksum) {
+        return std::nullopt;
+    }
+
+    auto before = allocations.load(std::memory_order_relaxed);
+    cppeg_bench::do_not_optimize(parse(text));
+    auto allocs = allocations.load(std::memory_order_relaxed) - before;
+
+    // About 8 MB of input per batch, so small inputs are not dominated
+    // by timer resolution and large ones do not take forever.
+    int  calls = static_cast<int>(std::max<std::size_t>(
+        1, (std::size_t{8} << 20) / std::max<std::size_t>(text.size(), 1)));
+    int  batches = text.size() >= (std::size_t{256} << 20) ? 1 : 3;
+    auto ns      = cppeg_bench::best_ns_per_call(
+        [&] { cppeg_bench::do_not_optimize(parse(text)); }, calls, batches);
+
+    report(grammar, parser, size, text.size(), ns, allocs,
+           cppeg_bench::peak_rss_bytes());
+
+    // A batch of its own, so the counters see only parsing.
+    if (perf) {
+        perf->start();
+        for (int i = 0; i < calls; ++i) {
+            cppeg_bench::do_not_optimize(parse(text));
+        }
+        perf->stop();
+        report_perf(*perf, static_cast<double>(calls) * text.size());
+    }
+    return checksum;
+}
+
+template<typename Grammar, typename Generate, typename Baseline>
+bool run(Options const &opts, cppeg_bench::PerfCounters *perf,
+         std::string_view name, Generate &&generate, Baseline &&baseline) {
+    if (!opts.grammars.empty() &&
+        std::find(opts.grammars.begin(), opts.grammars.end(), name) ==
+            opts.grammars.end()) {
+        return true;
+    }
+
+    Grammar grammar;
+    for (std::size_t size = 1 << 10; size <= opts.max_size; size *= 32) {
+        std::string const text = generate(size);
+
+        auto parse  = [&](std::string_view t) { return grammar.parse(t); };
+        auto ours   = measure(name, "cppeg", size, text, parse, perf);
+        auto theirs = measure(name, "baseline", size, text, baseline, perf);
+        if (!ours || !theirs || *ours != *theirs) {
+            std::fprintf(stderr,
+                         "%.*s, %s: cppeg and the baseline disagree "
+                         "(%s vs %s)\n",
+                         static_cast<int>(name.size()), name.data(),
+                         size_label(size).c_str(),
+                         ours ? std::to_string(*ours).c_str() : "rejected",
+                         theirs ? std::to_string(*theirs).c_str()
+                                : "rejected");
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    using namespace cppeg_bench;
+
+    Options opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--max-size" && i + 1 < argc) {
+            auto size = parse_size(argv[++i]);
+            if (!size) {
+                std::fprintf(stderr, "bad size: %s\n", argv[i]);
+                return 2;
+            }
+            opts.max_size = *size;
+        } else if (arg == "--perf") {
+            opts.perf = true;
+        } else if (arg.substr(0, 2) == "--") {
+            std::fprintf(stderr,
+                         "usage: %s [--max-size N[K|M|G]] [--perf] [grammar...]\n"
+                         "grammars: expr csv json ini access_log\n",
+                         argv[0]);
+            return 2;
+        } else {
+            opts.grammars.emplace_back(arg);
+        }
+    }
+
+    if (!reset_peak_rss()) {
+        std::printf("(peak RSS cannot be reset here: figures are the peak "
+                    "of the run so far)\n");
+    }
+
+    std::optional<PerfCounters> counters;
+    if (opts.perf) {
+        counters.emplace();
+        if (!counters->any_available()) {
+            std::printf("(no hardware counters: %s)\n", counters->error());
+            counters.reset();
+        } else if (counters->error()) {
+            std::printf("(some hardware counters missing: %s)\n",
+                        counters->error());
+        }
+    }
+    PerfCounters *perf = counters ? &*counters : nullptr;
+
+    bool ok =
+        run<expr::Grammar>(opts, perf, "expr", expr::generate,
+                           expr::baseline) &&
+        run<csv::Grammar>(opts, perf, "csv", csv::generate, csv::baseline) &&
+        run<json::Grammar>(opts, perf, "json", json::generate,
+                           json::baseline) &&
+        run<ini::Grammar>(opts, perf, "ini", ini::generate, ini::baseline) &&
+        run<access_log::Grammar>(opts, perf, "access_log",
+                                 access_log::generate, access_log::baseline);
+    return ok ? 0 : 1;
+}
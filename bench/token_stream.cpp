@@ -0,0 +1,104 @@
+// Char-level parsing against lexing once and parsing tokens.
+//
+// Three statement forms share a leading identifier, so the char-level
+// grammar re-scans the identifier (and the whitespace around it) for
+// every alternative it backtracks out of. The token-level grammar
+// lexes the text once into a Token array; backtracking then costs one
+// kind compare per token. Reported per statement, with lexing both
+// included and excluded: with backtracking this shallow, lexing costs
+// about what it saves, so the token stream pays off once the grammar
+// backtracks further or the tokens are parsed more than once.
+
+#include "cppeg.hpp"
+#include "harness.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace cppeg;
+
+namespace {
+
+enum Kind : std::uint32_t { ident, assign, lparen, rparen, dot, semi };
+
+auto ident_rule() {
+    using lower = CharRng<'a', 'z'>;
+    return ~CharClass<lower>{} + *~CharClass<lower, CharRng<'0', '9'>>{};
+}
+
+template<typename Stmt, typename Stream>
+std::size_t run(Stmt rule, Stream &S) {
+    std::size_t n = 0;
+    while (parse_success(rule.parse(S))) {
+        ++n;
+    }
+    cppeg_bench::do_not_optimize(n);
+    return n;
+}
+
+} // namespace
+
+int main() {
+    // name = name;  |  name(name);  |  name.name(name);
+    char const *names[] = {"alpha", "beta", "gamma42", "delta", "epsilon"};
+    std::string text;
+    unsigned    seed = 12345;
+    for (int i = 0; i < 60000; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        auto a = names[(seed >> 16) % 5];
+        auto b = names[(seed >> 20) % 5];
+        text += a;
+        switch ((seed >> 24) % 3) {
+        case 0: text += " = "; text += b; text += ";\n"; break;
+        case 1: text += " ( "; text += b; text += " );\n"; break;
+        case 2: text += " . "; text += b; text += "(x);\n"; break;
+        }
+    }
+
+    {
+        auto id   = ~span(ident_rule());
+        auto stmt = (id + Char<'='> + id + Char<';'>) |
+                    (id + Char<'('> + id + Char<')'> + Char<';'>) |
+                    (id + Char<'.'> + id + Char<'('> + id + Char<')'> +
+                     Char<';'>);
+
+        auto parse = [&] {
+            InputStream<char, SkipWhitespace> S(text);
+            return run(stmt, S);
+        };
+        auto n  = parse();
+        auto ns = cppeg_bench::best_ns_per_call(parse);
+        cppeg_bench::report("chars", ns, n, "stmt");
+    }
+
+    {
+        auto lex = lexer(AnyChar<' ', '\n'>{}, token<ident>(ident_rule()),
+                         token<assign>(Char<'='>), token<lparen>(Char<'('>),
+                         token<rparen>(Char<')'>), token<dot>(Char<'.'>),
+                         token<semi>(Char<';'>));
+
+        auto id   = ~Tok<ident>;
+        auto stmt = (id + ~Tok<assign> + id + ~Tok<semi>) |
+                    (id + ~Tok<lparen> + id + ~Tok<rparen> + ~Tok<semi>) |
+                    (id + ~Tok<dot> + id + ~Tok<lparen> + id + ~Tok<rparen> +
+                     ~Tok<semi>);
+
+        std::vector<Token> tokens;
+        auto lex_and_parse = [&] {
+            tokens.clear();
+            lex.tokenize(text, tokens);
+            TokenStream S(text, tokens);
+            return run(stmt, S);
+        };
+        auto n  = lex_and_parse();
+        auto ns = cppeg_bench::best_ns_per_call(lex_and_parse);
+        cppeg_bench::report("tokens, lex + parse", ns, n, "stmt");
+
+        auto parse = [&] {
+            TokenStream S(text, tokens);
+            return run(stmt, S);
+        };
+        ns = cppeg_bench::best_ns_per_call(parse);
+        cppeg_bench::report("tokens, parse only", ns, n, "stmt");
+    }
+}
@@ -0,0 +1,87 @@
+// Whitespace skipping: the vectorized ASCII routine used by InputStream
+// against the per-char std::isspace loop it replaced.
+
+#include "cppeg.hpp"
+#include "harness.hpp"
+
+#include <cctype>
+#include <string>
+
+using namespace cppeg;
+
+namespace {
+
+// Indented, JSON-ish text: each line is `indent` spaces and a short
+// token.
+std::string make_input(std::size_t lines, std::size_t indent) {
+    std::string s;
+    for (std::size_t i = 0; i < lines; ++i) {
+        s.append(indent, ' ');
+        s += "a,\n";
+    }
+    return s;
+}
+
+// The loop InputStream used to run once per char read.
+std::size_t isspace_loop(std::string_view text, std::size_t p) {
+    while (p < text.size() && std::isspace(text[p])) {
+        ++p;
+    }
+    return p;
+}
+
+// Visit every token, skipping the whitespace in between.
+template<typename Skip>
+std::size_t walk(std::string_view text, Skip skip) {
+    std::size_t tokens = 0;
+    std::size_t p      = skip(text, 0);
+    while (p < text.size()) {
+        ++tokens;
+        p = skip(text, p + 1);
+    }
+    return tokens;
+}
+
+void bench_skip(std::size_t indent) {
+    auto text  = make_input(1 << 14, indent);
+    auto label = " (indent " + std::to_string(indent) + ")";
+
+    auto simd_ns = cppeg_bench::best_ns_per_call([&] {
+        cppeg_bench::do_not_optimize(walk(text, [](auto t, auto p) {
+            return detail::skip_ascii_whitespace(t, p);
+        }));
+    });
+    auto loop_ns = cppeg_bench::best_ns_per_call([&] {
+        cppeg_bench::do_not_optimize(walk(text, isspace_loop));
+    });
+
+    cppeg_bench::report("skip_ascii_whitespace" + label, simd_ns,
+                        text.size(), "byte");
+    cppeg_bench::report("std::isspace loop" + label, loop_ns, text.size(),
+                        "byte");
+}
+
+void bench_parse(std::size_t indent) {
+    auto text  = make_input(1 << 14, indent);
+    auto label = " (indent " + std::to_string(indent) + ")";
+
+    auto line = ~(Char<'a'> + Char<','>);
+    auto ns   = cppeg_bench::best_ns_per_call([&] {
+        InputStream<> S(text, true);
+        std::size_t   n = 0;
+        while (parse_success(line.parse(S))) {
+            ++n;
+        }
+        cppeg_bench::do_not_optimize(n);
+    });
+    cppeg_bench::report("InputStream parse" + label, ns, text.size(), "byte");
+}
+
+} // namespace
+
+int main() {
+    for (std::size_t indent : {0, 2, 8, 32, 128}) {
+        bench_skip(indent);
+        bench_parse(indent);
+    }
+}
@@ -0,0 +1,267 @@
+#ifndef CPPEG_ARENA_HPP
+#define CPPEG_ARENA_HPP
+
+#include "cppeg_common.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+CPPEG_NAMESPACE_OPEN
+
+/**
+ * Monotonic memory for the results of one parse (see ArenaResults).
+ * Allocation bumps a pointer through blocks of growing size taken from
+ * the heap, and deallocation does nothing: release() frees everything
+ * in one go. The blocks themselves are kept for the next parse, so an
+ * arena reused across documents stops touching the heap at all; they
+ * go back to it with clear() or the arena's destruction.
+ */
+class Arena : public std::pmr::memory_resource {
+public:
+    static constexpr std::size_t default_block_size = std::size_t{1} << 14;
+
+    explicit Arena(std::size_t block_size = default_block_size)
+        : m_next_size(std::max(block_size, alignof(std::max_align_t))) {}
+
+    Arena(Arena const &) = delete;
+    Arena &operator=(Arena const &) = delete;
+
+    ~Arena() override { clear(); }
+
+    std::pmr::memory_resource *resource() noexcept { return this; }
+
+    // Everything allocated from the arena so far is freed; results
+    // still using it must not be touched afterwards.
+    void release() noexcept {
+        m_block = 0;
+        m_used  = 0;
+    }
+
+    // release(), and return the blocks to the heap.
+    void clear() noexcept {
+        for (auto &b : m_blocks) {
+            ::operator delete(b.data);
+        }
+        m_blocks.clear();
+        release();
+    }
+
+    // Bytes held in blocks, used or not.
+    std::size_t capacity() const noexcept {
+        std::size_t n = 0;
+        for (auto &b : m_blocks) {
+            n += b.size;
+        }
+        return n;
+    }
+
+private:
+    struct Block {
+        char       *data;
+        std::size_t size;
+    };
+
+    void *do_allocate(std::size_t bytes, std::size_t align) override {
+        while (m_block < m_blocks.size()) {
+            auto &b     = m_blocks[m_block];
+            auto  start = (reinterpret_cast<std::uintptr_t>(b.data) + m_used +
+                          align - 1) &
+                         ~(std::uintptr_t{align} - 1);
+            auto offset = static_cast<std::size_t>(
+                start - reinterpret_cast<std::uintptr_t>(b.data));
+            if (offset <= b.size && bytes <= b.size - offset) {
+                m_used = offset + bytes;
+                return b.data + offset;
+            }
+            ++m_block;
+            m_used = 0;
+        }
+
+        // Past the last block: double the size for the next one.
+        auto size = std::max(m_next_size, bytes + align);
+        m_next_size *= 2;
+        m_blocks.push_back({static_cast<char *>(::operator new(size)), size});
+        return do_allocate(bytes, align);
+    }
+
+    void do_deallocate(void *, std::size_t, std::size_t) override {}
+
+    bool do_is_equal(
+        std::pmr::memory_resource const &other) const noexcept override {
+        return this == &other;
+    }
+
+    std::vector<Block> m_blocks;
+    std::size_t        m_block{0}; // block being allocated from
+    std::size_t        m_used{0};  // bytes of it in use
+    std::size_t        m_next_size;
+};
+
+namespace detail {
+
+// A copy of a result whose pmr containers and strings, however deeply
+// nested in optionals, tuples and variants, draw on r. Their copy
+// constructors would use the default resource instead.
+template<typename T>
+T arena_copy(T const &x, std::pmr::memory_resource *r);
+template<typename T>
+std::optional<T> arena_copy(std::optional<T> const &x,
+                            std::pmr::memory_resource *r);
+template<typename... Ts>
+std::tuple<Ts...> arena_copy(std::tuple<Ts...> const &x,
+                             std::pmr::memory_resource *r);
+template<typename... Ts>
+std::variant<Ts...> arena_copy(std::variant<Ts...> const &x,
+                               std::pmr::memory_resource *r);
+template<typename T>
+std::pmr::vector<T> arena_copy(std::pmr::vector<T> const &x,
+                               std::pmr::memory_resource *r);
+template<typename C, typename Traits>
+std::pmr::basic_string<C, Traits>
+arena_copy(std::pmr::basic_string<C, Traits> const &x,
+           std::pmr::memory_resource *r);
+
+template<typename T>
+T arena_copy(T const &x, std::pmr::memory_resource *) {
+    return x;
+}
+
+template<typename T>
+std::optional<T> arena_copy(std::optional<T> const &x,
+                            std::pmr::memory_resource *r) {
+    if (!x) {
+        return std::nullopt;
+    }
+    return std::optional<T>(arena_copy(*x, r));
+}
+
+template<typename... Ts>
+std::tuple<Ts...> arena_copy(std::tuple<Ts...> const &x,
+                             std::pmr::memory_resource *r) {
+    return std::apply(
+        [&](auto const &...e) { return std::tuple<Ts...>(arena_copy(e, r)...); },
+        x);
+}
+
+template<typename... Ts, std::size_t... I>
+std::variant<Ts...> arena_copy_variant(std::variant<Ts...> const &x,
+                                       std::pmr::memory_resource *r,
+                                       std::index_sequence<I...>) {
+    std::variant<Ts...> ret;
+    ((x.index() == I
+          ? (void)ret.template emplace<I>(arena_copy(std::get<I>(x), r))
+          : void()),
+     ...);
+    return ret;
+}
+
+template<typename... Ts>
+std::variant<Ts...> arena_copy(std::variant<Ts...> const &x,
+                               std::pmr::memory_resource *r) {
+    return arena_copy_variant(x, r, std::index_sequence_for<Ts...>{});
+}
+
+// Elements moved in are rebuilt with the vector's allocator, which
+// keeps them on r.
+template<typename T>
+std::pmr::vector<T> arena_copy(std::pmr::vector<T> const &x,
+                               std::pmr::memory_resource *r) {
+    std::pmr::vector<T> ret(r);
+    ret.reserve(x.size());
+    for (auto const &e : x) {
+        ret.push_back(arena_copy(e, r));
+    }
+    return ret;
+}
+
+template<typename C, typename Traits>
+std::pmr::basic_string<C, Traits>
+arena_copy(std::pmr::basic_string<C, Traits> const &x,
+           std::pmr::memory_resource *r) {
+    return std::pmr::basic_string<C, Traits>(x, r);
+}
+
+} // end namespace detail
+
+// Results policies: the containers and strings that rules create for
+// their results (RepeatRule's vector, Literal's string), and how they
+// are constructed. An InputStream's (or StreamingInputStream's) third
+// parameter picks one.
+
+// Ordinary std::vector and std::string on the heap.
+struct HeapResults {
+    template<typename T>
+    using vector = std::vector<T>;
+    template<typename C>
+    using basic_string = std::basic_string<C>;
+    using string       = std::string;
+
+    template<typename C, typename Stream, typename... Args>
+    static C make(Stream &, Args &&...args) {
+        return C(std::forward<Args>(args)...);
+    }
+
+    // A copy of a result kept elsewhere, e.g. replayed by memoization.
+    template<typename Stream, typename T>
+    static T copy(Stream &, T const &x) {
+        return x;
+    }
+};
+
+// std::pmr containers drawing on the stream's arena,
+// stream.context().arena(). A parse then makes a few block allocations
+// instead of one per container, and containers nested in containers
+// share the arena, so moving them around copies nothing.
+//
+// Results live only as long as that arena. By default it is the
+// stream's own, so they dangle once the InputStream is destroyed; to
+// keep them longer, give the stream an arena of your own with
+// context().set_arena() (and do not release() it while they are used).
+struct ArenaResults {
+    template<typename T>
+    using vector = std::pmr::vector<T>;
+    template<typename C>
+    using basic_string = std::pmr::basic_string<C>;
+    using string       = std::pmr::string;
+
+    template<typename C, typename Stream, typename... Args>
+    static C make(Stream &in, Args &&...args) {
+        return C(std::forward<Args>(args)..., in.context().arena().resource());
+    }
+
+    template<typename Stream, typename T>
+    static T copy(Stream &in, T const &x) {
+        return detail::arena_copy(x, in.context().arena().resource());
+    }
+};
+
+namespace detail {
+
+template<typename Stream, typename = void>
+struct results_policy {
+    using type = HeapResults;
+};
+
+template<typename Stream>
+struct results_policy<Stream, std::void_t<typename Stream::results_policy>> {
+    using type = typename Stream::results_policy;
+};
+
+// The stream's Results policy; HeapResults for streams without one.
+template<typename Stream>
+using results_policy_t = typename results_policy<Stream>::type;
+
+} // end namespace detail
+
+CPPEG_NAMESPACE_CLOSE
+
+#endif
@@ -4,6 +4,10 @@
 #include <cassert>
 #include <iostream>
 
+#ifndef STR
+#define STR(X) #X
+#endif
+
 #ifndef NDEBUG
 #define debug_assert(COND, MSG) \
     if(!(COND)) {  \
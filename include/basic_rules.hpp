@@ -1,23 +1,50 @@
 #ifndef CPPEG_BASIC_RULES
 #define CPPEG_BASIC_RULES
 
+#include "arena.hpp"
+#include "char_table.hpp"
 #include "cppeg_common.hpp"
+#include "meta.hpp"
 #include "rule.hpp"
+#include <array>
 #include <optional>
 #include <cmath>
+#include <string_view>
+#include <type_traits>
 
 #include <iostream> //for debugging
 
 CPPEG_NAMESPACE_OPEN
 
+// The rules in this file consume either exactly their match or
+// nothing, so they opt out of Rule::parse checkpointing. They are
+// the terminals failures are reported for (see failure.hpp).
+
 template<char C>
 struct CharRule : public Rule<CharRule<C>> {
+    static constexpr bool restores_on_failure = true;
+    static constexpr bool reports_failure     = true;
+
+    static constexpr char name[] = {'\'', C, '\'', '\0'};
+    static constexpr std::string_view expected_name() { return name; }
+
+    static constexpr detail::CharTable char_table() {
+        return detail::CharTable{}.set(static_cast<unsigned char>(C));
+    }
+    static constexpr detail::FirstSet first_set() {
+        return detail::FirstSet::of_char(char_table());
+    }
 
+    // The test parse_impl applies to the next char, of any char type.
     template<typename T>
-    auto parse_impl(InputStream<T> &in) {
+    static constexpr bool contains(T c) {
+        return c == C;
+    }
+
+    template<typename Stream>
+    auto parse_impl(Stream &in) {
         std::optional<char> ret;
-        auto c = in.getChar();
-        if (c == C) {
+        if (in.next_if([](auto c) { return contains(c); })) {
             ret = C;
         }
         return ret;
@@ -30,12 +57,40 @@ constexpr CharRule<C> Char = CharRule<C>{};
 
 template<char First, char Last>
 struct CharRng : public Rule<CharRng<First, Last>> {
+    static constexpr bool restores_on_failure = true;
+    static constexpr bool reports_failure     = true;
+
+    static constexpr char name[] = {'[', First, '-', Last, ']', '\0'};
+    static constexpr std::string_view expected_name() { return name; }
+
+    // The same (char) comparison as parse_impl, which differs from an
+    // unsigned range when the bounds straddle 0x80.
+    static constexpr detail::CharTable char_table() {
+        detail::CharTable t;
+        for (unsigned v = 0; v < 256; ++v) {
+            auto c = static_cast<char>(v);
+            if (c >= First && c <= Last) {
+                t.set(static_cast<unsigned char>(v));
+            }
+        }
+        return t;
+    }
+    static constexpr detail::FirstSet first_set() {
+        return detail::FirstSet::of_char(char_table());
+    }
+
+    // As for CharRule. A wide char is compared with the (char) bounds.
     template<typename T>
-    auto parse_impl(InputStream<T> &in) {
-        auto c = in.getChar();
+    static constexpr bool contains(T c) {
+        return c >= First && c <= Last;
+    }
+
+    template<typename Stream>
+    auto parse_impl(Stream &in) {
+        auto c = in.next_if([](auto c) { return contains(c); });
         std::optional<char> ret;
-        if (c >= First && c <= Last) {
-            ret = c;
+        if (c) {
+            ret = *c;
         }
         return ret;
     }
@@ -46,26 +101,29 @@ struct Literal : public Rule<Literal> {
     Literal(std::string const& s) : m_literal(s) {}
     Literal(std::string &&s) : m_literal(std::forward<std::string>(s)) {}
 
-    template<typename T>
-    auto parse_impl(InputStream<T> &in) {
-	auto N = m_literal.size();
-	std::optional<std::string> ret;
+    static constexpr bool restores_on_failure = true;
+    static constexpr bool reports_failure     = true;
 
-	auto c = in.peekChar();
+    // The text is only known at run time, so a ParseError names the
+    // kind of token rather than quoting it (StaticLiteral does).
+    static constexpr std::string_view expected_name() { return "literal"; }
 
-	auto stream_iter = in.get_iter();
-	auto stream_end = in.end();
-	auto dist_to_end = in.distance_to_end();
+    // A copy of the text, as the stream's results policy's string.
+    template<typename Stream>
+    auto parse_impl(Stream &in) {
+	using policy = detail::results_policy_t<Stream>;
+	using string = typename policy::string;
 
-	auto in_stream = std::basic_string_view<T>(stream_iter, std::min(N, dist_to_end));
-	if(m_literal == in_stream) {
-	    ret = m_literal;
-	    in.advance_n_unchecked(in_stream.size());
+	std::optional<string> ret;
+	if(in.match(m_literal)) {
+	    ret = policy::template make<string>(in, m_literal.data(),
+	                                        m_literal.size());
 	}
-	
 	return ret;
     }
 
+    std::string const &text() const noexcept { return m_literal; }
+
 private:
     std::string m_literal;
 };
@@ -76,14 +134,144 @@ inline Literal operator "" _L(const char* str, std::size_t N) {
 }
 
 
+/**
+ * Same match as Literal, but the result is a view of the matched
+ * input instead of a copy of the literal, so a successful match never
+ * allocates. The view has the lifetime of the stream's text. On
+ * streams whose span() is a copy (StreamingInputStream) it views the
+ * rule's own text instead, the same chars, and so lives as long as
+ * the rule.
+ */
+struct LiteralView : public Rule<LiteralView> {
+    LiteralView(std::string const& s) : m_literal(s) {}
+    LiteralView(std::string &&s) : m_literal(std::forward<std::string>(s)) {}
+
+    static constexpr bool restores_on_failure = true;
+    static constexpr bool reports_failure     = true;
+
+    // As for Literal.
+    static constexpr std::string_view expected_name() { return "literal"; }
+
+    template<typename Stream>
+    auto parse_impl(Stream &in) {
+	using span_type = decltype(in.span(0, 0));
+	constexpr bool span_is_view = meta::is_string_view_v<span_type>;
+	using view_type =
+	    std::conditional_t<span_is_view, span_type, std::string_view>;
+	std::optional<view_type> ret;
+	if(in.match(m_literal)) {
+	    if constexpr (span_is_view) {
+		auto end = in.get_pos();
+		ret = in.span(end - m_literal.size(), end);
+	    } else {
+		ret = std::string_view(m_literal);
+	    }
+	}
+	return ret;
+    }
+
+    std::string const &text() const noexcept { return m_literal; }
+
+private:
+    std::string m_literal;
+};
+
+inline LiteralView operator "" _Lv(const char* str, std::size_t N) {
+    return LiteralView(std::string(str,N));
+}
+
+
+/**
+ * Literal whose text is part of the type. The rule object is empty,
+ * the length is a constant, and the result is a view of the static
+ * copy of the text, so nothing is stored, copied or allocated. On a
+ * wide stream the copy is of the stream's char type, and so is the
+ * view: std::wstring_view on an InputStream<wchar_t>.
+ */
+template<char ...Cs>
+struct StaticLiteral : public Rule<StaticLiteral<Cs...>> {
+    static constexpr bool restores_on_failure = true;
+    static constexpr bool reports_failure     = true;
+
+    static constexpr std::array<char, sizeof...(Cs)> text{Cs...};
+
+    // text as T, each char converted as CharRule compares it.
+    template<typename T>
+    static constexpr std::array<T, sizeof...(Cs)> text_as{T(Cs)...};
+
+    static constexpr char name[] = {'"', Cs..., '"', '\0'};
+    static constexpr std::string_view expected_name() { return name; }
+
+    static constexpr detail::FirstSet first_set() {
+        if constexpr (sizeof...(Cs) == 0) {
+            return detail::FirstSet::empty();
+        } else {
+            auto first = static_cast<unsigned char>(text[0]);
+            return detail::FirstSet::of_char(detail::CharTable{}.set(first));
+        }
+    }
+
+    template<typename Stream>
+    auto parse_impl(Stream &in) {
+	using T = typename decltype(in.lookahead(0))::value_type;
+	constexpr auto const &chars = text_as<T>;
+
+	std::optional<std::basic_string_view<T>> ret;
+	if(in.match(chars)) {
+	    ret = std::basic_string_view<T>(chars.data(), chars.size());
+	}
+	return ret;
+    }
+};
+
+template<char ...Cs>
+constexpr StaticLiteral<Cs...> Lit = StaticLiteral<Cs...>{};
+
+#ifdef __GNUC__
+// "GET"_lit == Lit<'G','E','T'>. String literal operator templates are
+// a GNU extension (supported by gcc and clang), hence the guard.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#ifdef __clang__
+#pragma GCC diagnostic ignored "-Wgnu-string-literal-operator-template"
+#endif
+template<typename CharT, CharT ...Cs>
+constexpr StaticLiteral<Cs...> operator "" _lit() {
+    return {};
+}
+#pragma GCC diagnostic pop
+#endif
+
+
 template<char ...Cs>
 struct AnyChar : public Rule<AnyChar<Cs...>> {
+    static constexpr bool restores_on_failure = true;
+    static constexpr bool reports_failure     = true;
+
+    static constexpr char name[] = {'[', Cs..., ']', '\0'};
+    static constexpr std::string_view expected_name() { return name; }
+
+    static constexpr detail::CharTable char_table() {
+        detail::CharTable t;
+        (t.set(static_cast<unsigned char>(Cs)), ...);
+        return t;
+    }
+    static constexpr detail::FirstSet first_set() {
+        return detail::FirstSet::of_char(char_table());
+    }
+
+    // As for CharRule: one table lookup rather than a chain of compares.
     template<typename T>
-    auto parse_impl(InputStream<T> &in) {
-	auto c = in.getNext();
+    static constexpr bool contains(T c) {
+        return detail::char_table_v<AnyChar>.test_char(c);
+    }
+
+    template<typename Stream>
+    auto parse_impl(Stream &in) {
+	auto c = in.next_if([](auto c) { return contains(c); });
 	std::optional<char> ret;
-	if( ( (Cs==c) || ...) ) {
-	    ret = c;
+	if(c) {
+	    ret = *c;
 	}
 	return ret;
     }
@@ -0,0 +1,142 @@
+#ifndef CPPEG_CHAR_CLASS_HPP
+#define CPPEG_CHAR_CLASS_HPP
+
+#include "basic_rules.hpp"
+#include "char_table.hpp"
+#include "cppeg_common.hpp"
+#include "compound_rules.hpp"
+#include "rule.hpp"
+
+#include <optional>
+#include <string_view>
+#include <type_traits>
+
+CPPEG_NAMESPACE_OPEN
+
+/**
+ * Matches one char from a set built at compile time out of Items:
+ * CharRule, CharRng, AnyChar, or other CharClassRules. The set is a
+ * constexpr 256-bit table, so a match is a single lookup whatever the
+ * number of items, and the result is a plain char (no variant).
+ * On wide streams, chars past ASCII are tested as each item's own rule
+ * would (CharRng compares them with its char bounds), which the table
+ * cannot describe; NotCharClass<AnyChar<'"'>> accepts any of them.
+ *
+ *   CharClass<CharRng<'A','Z'>, CharRng<'a','z'>, CharRule<'_'>>  // [A-Za-z_]
+ *   NotCharClass<AnyChar<'"', '\\'>>                              // [^"\\]
+ */
+template<bool Negated, typename... Items>
+struct CharClassRule : public Rule<CharClassRule<Negated, Items...>> {
+    static constexpr bool restores_on_failure = true;
+    static constexpr bool reports_failure     = true;
+
+    // A class may hold many chars and ranges, so a ParseError names the
+    // kind of token, as for Literal.
+    static constexpr std::string_view expected_name() {
+        return Negated ? "character not in class" : "character class";
+    }
+
+    static constexpr detail::CharTable char_table() {
+        auto t = (detail::CharTable{} | ... | Items::char_table());
+        return Negated ? ~t : t;
+    }
+    static constexpr detail::FirstSet first_set() {
+        return detail::FirstSet::of_char(char_table());
+    }
+
+    // The test parse_impl applies to the next char, of any char type.
+    template<typename T>
+    static constexpr bool contains(T c) {
+        if constexpr (sizeof(T) > 1) {
+            if (!(c >= 0 && c < 128)) {
+                return Negated != (false || ... || Items::contains(c));
+            }
+        }
+        return detail::char_table_v<CharClassRule>.test_char(c);
+    }
+
+    // The stream's char type: a wide char past the table may match.
+    template<typename Stream>
+    auto parse_impl(Stream &in) {
+        auto c = in.next_if([](auto c) { return contains(c); });
+        std::optional<typename decltype(c)::value_type> ret;
+        if (c) {
+            ret = *c;
+        }
+        return ret;
+    }
+};
+
+template<typename... Items>
+using CharClass = CharClassRule<false, Items...>;
+
+template<typename... Items>
+using NotCharClass = CharClassRule<true, Items...>;
+
+namespace detail {
+
+template<typename R>
+struct is_char_class_item : std::false_type {};
+template<char C>
+struct is_char_class_item<CharRule<C>> : std::true_type {};
+template<char F, char L>
+struct is_char_class_item<CharRng<F, L>> : std::true_type {};
+template<char... Cs>
+struct is_char_class_item<AnyChar<Cs...>> : std::true_type {};
+template<bool N, typename... Items>
+struct is_char_class_item<CharClassRule<N, Items...>> : std::true_type {};
+
+template<typename R>
+struct is_char_rule : std::false_type {};
+template<char C>
+struct is_char_rule<CharRule<C>> : std::true_type {};
+
+// a | b folds into a CharClass when both sides are char-class items.
+// Char<'a'> | Char<'b'> alone stays an OrRule, as it always has.
+template<typename L, typename R>
+constexpr bool folds_to_char_class_v =
+    is_char_class_item<L>::value && is_char_class_item<R>::value &&
+    !(is_char_rule<L>::value && is_char_rule<R>::value);
+
+// The items a (non-negated) class contributes when merged into another.
+template<typename R>
+struct class_items {
+    using type = std::tuple<R>;
+};
+template<typename... Items>
+struct class_items<CharClassRule<false, Items...>> {
+    using type = std::tuple<Items...>;
+};
+
+template<typename L, typename R>
+struct merged_class;
+template<typename... L, typename... R>
+struct merged_class<std::tuple<L...>, std::tuple<R...>> {
+    using type = CharClass<L..., R...>;
+};
+
+} // end namespace detail
+
+template<typename L, typename R,
+         typename = std::enable_if_t<detail::folds_to_char_class_v<L, R>>>
+auto operator|(L const &, R const &) {
+    return typename detail::merged_class<
+        typename detail::class_items<L>::type,
+        typename detail::class_items<R>::type>::type{};
+}
+
+// Complement of a char-class item: negate(CharRng<'0','9'>{}) is [^0-9].
+template<typename R, typename = std::enable_if_t<
+                         detail::is_char_class_item<R>::value>>
+auto negate(R const &) {
+    return NotCharClass<R>{};
+}
+
+template<bool N, typename... Items>
+auto negate(CharClassRule<N, Items...> const &) {
+    return CharClassRule<!N, Items...>{};
+}
+
+CPPEG_NAMESPACE_CLOSE
+
+#endif
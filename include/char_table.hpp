@@ -0,0 +1,136 @@
+#ifndef CPPEG_CHAR_TABLE_HPP
+#define CPPEG_CHAR_TABLE_HPP
+
+#include "cppeg_common.hpp"
+
+#include <array>
+#include <cstdint>
+
+CPPEG_NAMESPACE_OPEN
+
+namespace detail {
+
+/**
+ * Constexpr 256-bit set of byte values. Char-matching rules describe
+ * themselves with one (char_table()) so they can be merged into a
+ * single CharClass lookup at compile time.
+ */
+struct CharTable {
+    std::array<std::uint64_t, 4> bits{};
+
+    constexpr bool test(unsigned char c) const {
+        return (bits[c >> 6] >> (c & 63)) & 1u;
+    }
+
+    // Any other char type: only values 0..255 can be members.
+    template<typename T>
+    constexpr bool test_char(T c) const {
+        if constexpr (sizeof(T) == 1) {
+            return test(static_cast<unsigned char>(c));
+        } else {
+            return c >= 0 && c < 256 && test(static_cast<unsigned char>(c));
+        }
+    }
+
+    constexpr CharTable &set(unsigned char c) {
+        bits[c >> 6] |= std::uint64_t{1} << (c & 63);
+        return *this;
+    }
+
+    constexpr CharTable &set_range(unsigned char first, unsigned char last) {
+        for (unsigned c = first; c <= last; ++c) {
+            set(static_cast<unsigned char>(c));
+        }
+        return *this;
+    }
+
+    constexpr CharTable operator|(CharTable const &o) const {
+        CharTable r;
+        for (int i = 0; i < 4; ++i) {
+            r.bits[i] = bits[i] | o.bits[i];
+        }
+        return r;
+    }
+
+    constexpr CharTable operator~() const {
+        CharTable r;
+        for (int i = 0; i < 4; ++i) {
+            r.bits[i] = ~bits[i];
+        }
+        return r;
+    }
+
+    constexpr bool operator==(CharTable const &o) const {
+        return bits[0] == o.bits[0] && bits[1] == o.bits[1] &&
+               bits[2] == o.bits[2] && bits[3] == o.bits[3];
+    }
+};
+
+// R::char_table(), evaluated once at compile time, for rules that
+// match one char with a table lookup.
+template<typename R>
+inline constexpr CharTable char_table_v = R::char_table();
+
+/**
+ * What a rule can start with: the chars its first consumed char may
+ * be, and whether it can succeed without consuming anything. Rules
+ * report it through first_set(); the default (unknown()) claims every
+ * char and nullability, so it never rules anything out. OrRule uses
+ * it to skip alternatives that cannot match the next char.
+ *
+ * cheap_reject says the rule already fails on a wrong first char with
+ * a single inline test (char rules, static literals), in which case
+ * skipping it gains nothing.
+ */
+struct FirstSet {
+    CharTable chars{};
+    bool      nullable{false};
+    bool      cheap_reject{false};
+
+    static constexpr FirstSet unknown() { return {~CharTable{}, true}; }
+    static constexpr FirstSet empty() { return {CharTable{}, true, true}; }
+
+    // A rule that must start with one of chars and rejects any other
+    // first char at once.
+    static constexpr FirstSet of_char(CharTable const &chars) {
+        return {chars, false, true};
+    }
+
+    // Alternatives: either may match.
+    constexpr FirstSet operator|(FirstSet const &o) const {
+        return {chars | o.chars, nullable || o.nullable,
+                cheap_reject && o.cheap_reject};
+    }
+
+    // Sequence: o only contributes when this can match nothing.
+    constexpr FirstSet then(FirstSet const &o) const {
+        if (!nullable) {
+            return *this;
+        }
+        return {chars | o.chars, o.nullable, cheap_reject && o.cheap_reject};
+    }
+
+    // Whether the rule may start with the next char c. The table holds
+    // chars, so on wide streams it only describes ASCII: CharRng and
+    // negated classes treat wide chars 128-255 unlike their bytes.
+    template<typename T>
+    constexpr bool may_start_with(T c) const {
+        if constexpr (sizeof(T) > 1) {
+            if (!(c >= 0 && c < 128)) {
+                return true;
+            }
+        }
+        return chars.test_char(c);
+    }
+
+    // Can an OrRule ever skip the rule?
+    constexpr bool excludes_some_char() const {
+        return !nullable && !(chars == ~CharTable{});
+    }
+};
+
+} // end namespace detail
+
+CPPEG_NAMESPACE_CLOSE
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef CPPEG_COMPOUND_RULES
 #define CPPEG_COMPOUND_RULES
 
+#include "arena.hpp"
 #include "cppeg_common.hpp"
 #include "helpers.hpp"
 #include "meta.hpp"
@@ -8,9 +9,15 @@
 
 #include "tmpl.hpp"
 
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <string_view>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 #include <variant>
+#include <vector>
 
 CPPEG_NAMESPACE_OPEN
 
@@ -22,8 +29,18 @@ struct AndRule : public Rule<AndRule<Subrules...>> {
     AndRule(Rule<Subrules> const &... subrules)
         : subrules(std::forward_as_tuple(subrules.self()...)) {}
 
-    template<typename T>
-    auto parse_impl(InputStream<T> &in) {
+    // Once an earlier subrule has consumed input, a later failure
+    // must rewind it, so only a single-rule sequence is exempt.
+    static constexpr bool restores_on_failure = sizeof...(Subrules) == 1;
+
+    static constexpr detail::FirstSet first_set() {
+        auto f = detail::FirstSet::empty();
+        ((f = f.then(detail::first_set_of<Subrules>)), ...);
+        return f;
+    }
+
+    template<typename Stream>
+    auto parse_impl(Stream &in) {
 
         constexpr auto types   = tmpl::type_list<Subrules...>{};
         constexpr auto indices = tmpl::arithmetic_sequence<types.size()>();
@@ -78,24 +95,41 @@ struct AndRule : public Rule<AndRule<Subrules...>> {
         });
 
         if (parse_success_sofar) {
-            return_tuple_type parse_results;
-            constexpr auto    out_indices =
-                tmpl::arithmetic_sequence<filtered_types.size()>();
-            tmpl::for_each(tmpl::zip(filtered_list, out_indices), [&](auto x) {
-                constexpr auto X    = tmpl::unbox(std::decay_t<decltype(x)>{});
-                constexpr auto outI = static_cast<std::size_t>(X.value());
-                constexpr auto filtered_tv = X.type();
-                constexpr auto parserI =
-                    static_cast<std::size_t>(tmpl::unbox(filtered_tv).value());
-                std::get<outI>(parse_results) =
-                    std::move(std::get<parserI>(tmp_ret).value());
-            });
-            ret = parse_results;
+            emplace_results<Stream>(
+                ret, tmp_ret,
+                std::make_index_sequence<
+                    std::tuple_size_v<return_tuple_type>>());
         }
 
         return ret;
     }
 
+    // Index among Subrules of the n-th one whose result is kept (not
+    // null_parse).
+    template<typename Stream>
+    static constexpr std::size_t kept_index(std::size_t n) {
+        constexpr bool kept[] = {!std::is_same_v<
+            meta::remove_optional_t<std::decay_t<decltype(
+                std::declval<Subrules &>().parse(std::declval<Stream &>()))>>,
+            null_parse>...};
+        for (std::size_t i = 0; i < sizeof...(Subrules); ++i) {
+            if (kept[i] && n-- == 0) {
+                return i;
+            }
+        }
+        return sizeof...(Subrules);
+    }
+
+    // The result tuple is built in place from the moved subrule
+    // results: assigning into a default-constructed one would copy
+    // anything allocator-aware off the stream's arena (ArenaResults).
+    template<typename Stream, typename Ret, typename Tmp, std::size_t... Out>
+    static void emplace_results(Ret &ret, Tmp &tmp,
+                                std::index_sequence<Out...>) {
+        ret.emplace(take_parse_value(
+            std::move(std::get<kept_index<Stream>(Out)>(tmp)))...);
+    }
+
     // Rules are very lightweight by design. Store them by value
     // to avoid reference lifetime issues.
     using storage_type = std::tuple<Subrules...>;
@@ -131,6 +165,12 @@ auto operator+(Rule<L> const &lhs, AndRule<R...> const &rhs) {
  * Returns a std::variant<std::monostate, ...>, where the other variant
  * types are the set of types returned by the sub-parsers. The first parser
  * that succeeds will be the route taken.
+ *
+ * Alternatives whose first set (see FirstSet) excludes the next char
+ * are not tried at all: a table built at compile time maps each char
+ * to the alternatives that may match it, which are then tried in
+ * order as usual. When the stream tracks failures (see ParseError),
+ * every alternative is tried.
  */
 template<typename... Subrules>
 class OrRule : public Rule<OrRule<Subrules...>> {
@@ -138,8 +178,16 @@ public:
     OrRule(Rule<Subrules> const &... subrules)
         : subrules(std::forward_as_tuple(subrules.self()...)) {}
 
-    template<typename T>
-    auto parse_impl(InputStream<T> &in) {
+    // Fails only when every alternative failed, and each of those
+    // already rewound itself through Rule::parse.
+    static constexpr bool restores_on_failure = true;
+
+    static constexpr detail::FirstSet first_set() {
+        return (detail::first_set_of<Subrules> | ...);
+    }
+
+    template<typename Stream>
+    auto parse_impl(Stream &in) {
         constexpr auto raw_subrule_return_types = tmpl::type_list<
             std::decay_t<decltype(std::declval<Subrules>().parse(in))>...>{};
 
@@ -158,37 +206,105 @@ public:
 
         auto ret = tmpl::as_variant(return_variant_types);
 
-        constexpr auto indices =
-            tmpl::arithmetic_sequence<sizeof...(Subrules)>();
+        if constexpr (use_dispatch) {
+            static constexpr auto dispatch = make_dispatch();
+
+            // While failures are tracked, the alternatives the table
+            // rules out are tried as well, so that their terminals
+            // note what was expected here (see FailureSet).
+            auto viable = in.context().failures().enabled()
+                              ? all_alternatives
+                              : dispatch[next_char_index(in)];
+            try_from<0>(*this, in, ret, viable);
+        } else {
+            try_from<0>(*this, in, ret, all_alternatives);
+        }
 
-        bool parse_success = false;
-        tmpl::for_each(indices, [&](auto x) {
-            constexpr auto I = static_cast<std::size_t>(tmpl::unbox(x));
-            if (parse_success) {
-                return;
-            }
+        return ret;
+    }
 
-            auto tmp       = std::get<I>(subrules).parse(in);
-            using tmpT     = std::decay_t<decltype(tmp)>;
-            bool I_success = false;
-            if constexpr (meta::is_optional_v<tmpT>) {
-                I_success = tmp.has_value();
-                if (I_success) {
-                    parse_success = true;
-                    ret           = tmp.value();
-                }
-            } else if constexpr (meta::is_variant_v<tmpT>) {
-                I_success = !std::holds_alternative<std::monostate>(tmp);
-                if (I_success) {
-                    ret = tmp;
+    std::tuple<Subrules...> subrules;
+
+private:
+    using alternative_mask = std::uint64_t;
+
+    static constexpr alternative_mask all_alternatives = ~alternative_mask{0};
+
+    // Dispatch pays off once some alternative that is costly to try
+    // can be ruled out by the next char. When all of them reject on
+    // a single char test, trying them in order is just as fast.
+    static constexpr bool use_dispatch =
+        sizeof...(Subrules) <= 64 &&
+        ((detail::first_set_of<Subrules>.excludes_some_char() &&
+          !detail::first_set_of<Subrules>.cheap_reject) ||
+         ...);
+
+    // Tries alternatives From... in order, skipping those not in
+    // viable, until one succeeds. Past the 64 bits of the mask (no
+    // dispatch, so viable is all_alternatives) every one is tried.
+    template<std::size_t From, typename Stream, typename Ret>
+    static bool try_from(OrRule &self, Stream &in, Ret &ret,
+                         alternative_mask viable) {
+        if constexpr (From == sizeof...(Subrules)) {
+            return false;
+        } else {
+            bool in_mask = true;
+            if constexpr (From < 64) {
+                in_mask = (viable >> From) & 1;
+            }
+            if (in_mask) {
+                auto tmp = std::get<From>(self.subrules).parse(in);
+                if (cppeg::parse_success(tmp)) {
+                    ret = take_parse_value(std::move(tmp));
+                    return true;
                 }
             }
-        });
+            return try_from<From + 1>(self, in, ret, viable);
+        }
+    }
 
-        return ret;
+    // Entries 0-255: by char; 256: end of input; 257: chars no first
+    // set describes (wide chars past ASCII, see FirstSet::may_start_with).
+    static constexpr std::size_t end_of_input = 256;
+    static constexpr std::size_t wide_char    = 257;
+
+    static constexpr std::array<alternative_mask, 258> make_dispatch() {
+        constexpr detail::FirstSet sets[] = {
+            detail::first_set_of<Subrules>...};
+        constexpr std::size_t n = sizeof...(Subrules);
+
+        std::array<alternative_mask, 258> table{};
+        for (std::size_t c = 0; c < 258; ++c) {
+            for (std::size_t i = 0; i < n; ++i) {
+                bool ok = c == wide_char || sets[i].nullable ||
+                          (c < 256 && sets[i].chars.test(
+                                          static_cast<unsigned char>(c)));
+                if (ok) {
+                    table[c] |= alternative_mask{1} << i;
+                }
+            }
+        }
+        return table;
     }
 
-    std::tuple<Subrules...> subrules;
+    // A rejecting next_if reports the next char without consuming it
+    // or any skipped whitespace.
+    template<typename Stream>
+    static std::size_t next_char_index(Stream &in) {
+        std::size_t index = end_of_input;
+        in.next_if([&](auto c) {
+            if constexpr (!std::is_integral_v<decltype(c)>) {
+                index = wide_char; // e.g. a Token from TokenStream
+            } else if constexpr (sizeof(c) == 1) {
+                index = static_cast<unsigned char>(c);
+            } else {
+                index = (c >= 0 && c < 128) ? static_cast<std::size_t>(c)
+                                            : wide_char;
+            }
+            return false;
+        });
+        return index;
+    }
 };
 
 template<typename... Subrules>
@@ -222,8 +338,15 @@ public:
     CallbackRule(const Rule<R> &subrule, F &&func)
         : subrule(subrule.self()), func(std::forward<F>(func)) {}
 
-    template<typename T>
-    auto parse_impl(InputStream<T> &in) {
+    // Fails exactly when the subrule does, which rewinds itself.
+    static constexpr bool restores_on_failure = true;
+
+    static constexpr detail::FirstSet first_set() {
+        return detail::first_set_of<R>;
+    }
+
+    template<typename Stream>
+    auto parse_impl(Stream &in) {
         auto ret                   = subrule.parse(in);
         using callback_return_type = std::decay_t<decltype(func(ret))>;
         constexpr bool cb_returns_void =
@@ -258,8 +381,15 @@ class DiscardRule : public Rule<DiscardRule<R>> {
 public:
     DiscardRule(const Rule<R> &r) : subrule(r.self()) {}
 
-    template<typename T>
-    auto parse_impl(InputStream<T> &in) {
+    // Same reasoning as CallbackRule.
+    static constexpr bool restores_on_failure = true;
+
+    static constexpr detail::FirstSet first_set() {
+        return detail::first_set_of<R>;
+    }
+
+    template<typename Stream>
+    auto parse_impl(Stream &in) {
 
         std::optional<null_parse> ret;
         auto                      sub_ret = subrule.parse(in);
@@ -280,6 +410,254 @@ auto operator~(const Rule<R> &r) {
     return DiscardRule<R>(r);
 }
 
+//======================================================================
+
+/**
+ * Discards the subrule's result and returns a view of the input it
+ * matched instead (leading skipped whitespace excluded). Useful for
+ * identifiers, numbers and other tokens that would otherwise be built
+ * char by char. The result is whatever the stream's span() returns:
+ * a copy on StreamingInputStream, whose buffer moves as it reads.
+ */
+template<typename R>
+class SpanRule : public Rule<SpanRule<R>> {
+
+public:
+    SpanRule(const Rule<R> &r) : subrule(r.self()) {}
+
+    static constexpr detail::FirstSet first_set() {
+        return detail::first_set_of<R>;
+    }
+
+    template<typename Stream>
+    auto parse_impl(Stream &in) {
+        using span_type = decltype(in.span(0, 0));
+
+        in.peekChar(); // skip leading whitespace, if any
+        auto start = in.get_pos();
+
+        std::optional<span_type> ret;
+        if (parse_success(subrule.parse(in))) {
+            ret = in.span(start, in.get_pos());
+        }
+        return ret;
+    }
+
+private:
+    R subrule;
+};
+
+template<typename R>
+auto span(const Rule<R> &r) {
+    return SpanRule<R>(r);
+}
+
+//======================================================================
+
+/**
+ * The subrule under a name of your choosing. It parses exactly as the
+ * subrule does (failures still report the subrule as expected); the
+ * name is what profiles built with CPPEG_PROFILE list it as, in place
+ * of its type name (see profile.hpp).
+ */
+template<typename R>
+class NamedRule : public Rule<NamedRule<R>> {
+
+public:
+    NamedRule(std::string_view name, const Rule<R> &r)
+        : subrule(r.self()), m_name(name)
+#ifdef CPPEG_PROFILE
+          , m_counters(&profile::registry().counters(name))
+#endif
+    {}
+
+    static constexpr bool restores_on_failure = R::restores_on_failure;
+    static constexpr bool reports_failure     = R::reports_failure;
+
+    static constexpr std::string_view expected_name() {
+        return R::expected_name();
+    }
+    static constexpr detail::FirstSet first_set() {
+        return detail::first_set_of<R>;
+    }
+
+    // Calls parse_impl rather than parse, so the call is counted once,
+    // under the name.
+    template<typename Stream>
+    auto parse_impl(Stream &in) {
+        return subrule.parse_impl(in);
+    }
+
+    std::string const &name() const noexcept { return m_name; }
+
+#ifdef CPPEG_PROFILE
+    profile::Counters &profile_counters() const { return *m_counters; }
+#endif
+
+private:
+    R           subrule;
+    std::string m_name;
+#ifdef CPPEG_PROFILE
+    profile::Counters *m_counters;
+#endif
+};
+
+template<typename R>
+auto named(std::string_view name, const Rule<R> &r) {
+    return NamedRule<R>(name, r);
+}
+
+//======================================================================
+
+constexpr std::size_t unbounded = std::numeric_limits<std::size_t>::max();
+
+namespace detail {
+
+// Shared loop of the repetition rules. Parses subrule up to Max times,
+// handing each result to on_item, and returns the number of matches,
+// or nullopt if there were fewer than Min. Stops early if a match
+// consumed nothing, since it would then match forever; the iterations
+// still required up to Min are that same match, repeated.
+template<std::size_t Min, std::size_t Max, typename R, typename Stream,
+         typename F>
+std::optional<std::size_t> repeat_n(R &subrule, Stream &in, F &&on_item) {
+    std::size_t n = 0;
+    while (n < Max) {
+        auto before = in.get_pos();
+        auto r      = subrule.parse(in);
+        if (!parse_success(r)) {
+            break;
+        }
+        if (in.get_pos() == before) {
+            for (++n; n < Min; ++n) {
+                on_item(decltype(r)(r));
+            }
+            on_item(std::move(r));
+            break;
+        }
+        ++n;
+        on_item(std::move(r));
+    }
+
+    std::optional<std::size_t> ret;
+    if (n >= Min) {
+        ret = n;
+    }
+    return ret;
+}
+
+} // end namespace detail
+
+template<typename R, std::size_t Min, std::size_t Max, typename Container>
+class RepeatIntoRule;
+
+/**
+ * Matches the subrule between Min and Max times (greedy, no
+ * backtracking into the repetition). The result is a vector of the
+ * subrule's values (std::vector, or std::pmr::vector on the stream's
+ * arena with ArenaResults), or just the match count (std::size_t) when
+ * the subrule yields null_parse, so repeating a discarded rule never
+ * allocates. Use into() to collect values into a caller-owned
+ * container whose capacity is reused across parses.
+ */
+template<typename R, std::size_t Min, std::size_t Max>
+class RepeatRule : public Rule<RepeatRule<R, Min, Max>> {
+    static_assert(Min <= Max, "repeat: Min must not exceed Max");
+
+public:
+    RepeatRule(const Rule<R> &r) : subrule(r.self()) {}
+
+    // Can only fail before anything was consumed.
+    static constexpr bool restores_on_failure = Min <= 1;
+
+    static constexpr detail::FirstSet first_set() {
+        return Min == 0 ? detail::first_set_of<R> | detail::FirstSet::empty()
+                        : detail::first_set_of<R>;
+    }
+
+    template<typename Stream>
+    auto parse_impl(Stream &in) {
+        using sub_return_type = std::decay_t<decltype(subrule.parse(in))>;
+        using value_type      = meta::remove_optional_t<sub_return_type>;
+
+        if constexpr (std::is_same_v<value_type, null_parse>) {
+            return detail::repeat_n<Min, Max>(subrule, in, [](auto &&) {});
+        } else {
+            using policy = detail::results_policy_t<Stream>;
+            using vector = typename policy::template vector<value_type>;
+
+            std::optional<vector> ret;
+            auto values = policy::template make<vector>(in);
+            auto n = detail::repeat_n<Min, Max>(subrule, in, [&](auto &&x) {
+                values.push_back(take_parse_value(std::move(x)));
+            });
+            if (n) {
+                ret = std::move(values);
+            }
+            return ret;
+        }
+    }
+
+    // Append values to sink instead of returning a new vector. The
+    // result is the number of values appended; on failure the sink is
+    // left as it was.
+    template<typename Container>
+    auto into(Container &sink) const {
+        return RepeatIntoRule<R, Min, Max, Container>(subrule, sink);
+    }
+
+private:
+    R subrule;
+};
+
+template<typename R, std::size_t Min, std::size_t Max, typename Container>
+class RepeatIntoRule : public Rule<RepeatIntoRule<R, Min, Max, Container>> {
+
+public:
+    RepeatIntoRule(const Rule<R> &r, Container &sink)
+        : subrule(r.self()), sink(&sink) {}
+
+    static constexpr bool restores_on_failure = Min <= 1;
+
+    static constexpr detail::FirstSet first_set() {
+        return detail::first_set_of<RepeatRule<R, Min, Max>>;
+    }
+
+    template<typename Stream>
+    auto parse_impl(Stream &in) {
+        auto old_size = sink->size();
+        auto n = detail::repeat_n<Min, Max>(subrule, in, [&](auto &&x) {
+            sink->push_back(take_parse_value(std::move(x)));
+        });
+        if (!n) {
+            sink->erase(sink->begin() + old_size, sink->end());
+        }
+        return n;
+    }
+
+private:
+    R          subrule;
+    Container *sink;
+};
+
+// Kleene star: zero or more
+template<typename R>
+auto operator*(const Rule<R> &r) {
+    return RepeatRule<R, 0, unbounded>(r);
+}
+
+// one or more
+template<typename R>
+auto operator+(const Rule<R> &r) {
+    return RepeatRule<R, 1, unbounded>(r);
+}
+
+// between Min and Max times; exactly Min times if Max is not given
+template<std::size_t Min, std::size_t Max = Min, typename R>
+auto repeat(const Rule<R> &r) {
+    return RepeatRule<R, Min, Max>(r);
+}
+
 CPPEG_NAMESPACE_CLOSE
 
 #endif
@@ -3,10 +3,24 @@
 
 #include "cppeg_common.hpp"
 #include "input_stream.hpp"
+#if __has_include(<sys/mman.h>)
+#include "mapped_input_stream.hpp"
+#include "streaming_input_stream.hpp"
+#endif
 #include "rule.hpp"
+#include "failure.hpp"
 #include "helpers.hpp"
 #include "basic_rules.hpp"
 #include "compound_rules.hpp"
-//#include "predefined_parsers.hpp"
+#include "char_class.hpp"
+#include "literal_set.hpp"
+#include "symbols.hpp"
+#include "memo.hpp"
+#include "rule_ref.hpp"
+#include "left_recursion.hpp"
+#include "token_stream.hpp"
+#include "skip_rule.hpp"
+#include "predefined_parsers.hpp"
+#include "parallel.hpp"
 
 #endif
@@ -0,0 +1,197 @@
+#ifndef CPPEG_FAILURE_HPP
+#define CPPEG_FAILURE_HPP
+
+#include "cppeg_common.hpp"
+#include "type_name.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+CPPEG_NAMESPACE_OPEN
+
+using rule_id_type = std::uint64_t;
+
+namespace detail {
+
+constexpr rule_id_type fnv1a(std::string_view s) {
+    rule_id_type h = 14695981039346656037ull;
+    for (char c : s) {
+        h = (h ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    }
+    return h;
+}
+
+// Define CPPEG_NO_FAILURE_TRACKING to drop failure tracking from
+// Rule::parse altogether; ParseError then has no expectations.
+#ifdef CPPEG_NO_FAILURE_TRACKING
+inline constexpr bool track_failures = false;
+#else
+inline constexpr bool track_failures = true;
+#endif
+
+} // end namespace detail
+
+// Compile-time id of a rule type: a hash of its name.
+template<typename R>
+inline constexpr rule_id_type rule_id = detail::fnv1a(helpers::type_name<R>());
+
+// What a FailureSet records about a rule: its id, and how to describe
+// it in a ParseError (see Rule::expected_name). One static instance
+// per rule type.
+struct RuleInfo {
+    rule_id_type     id;
+    std::string_view name;
+};
+
+template<typename R>
+inline constexpr RuleInfo rule_info{rule_id<R>, R::expected_name()};
+
+/**
+ * The farthest position any terminal rule failed at during a parse,
+ * and what was expected there. Terminals (Rule::reports_failure) note
+ * their failures here; the success path is untouched.
+ *
+ * Tracking is opt-in per stream: until enable() is called, note()
+ * returns after testing a flag. Grammars that backtrack a lot fail at
+ * the frontier on nearly every token, so recording costs them even
+ * when no error is ever reported.
+ *
+ * At most max_expected distinct rules are kept per position; more set
+ * truncated().
+ */
+class FailureSet {
+public:
+    static constexpr std::size_t max_expected = 16;
+
+    // Start (or stop) recording failures.
+    void enable(bool on = true) noexcept { m_enabled = on; }
+    bool enabled() const noexcept { return m_enabled; }
+
+    void note(std::size_t pos, RuleInfo const &rule) {
+        if (!m_enabled || pos < m_farthest) {
+            return;
+        }
+        if (pos > m_farthest) {
+            m_farthest  = pos;
+            m_count     = 0;
+            m_seen      = 0;
+            m_truncated = false;
+        }
+        // Most rules noted at a position are new to it; the bit mask
+        // spares the search for them.
+        auto bit = std::uint64_t{1} << (rule.id & 63);
+        if ((m_seen & bit) && contains(&rule)) {
+            return;
+        }
+        m_seen |= bit;
+        if (m_count == max_expected) {
+            m_truncated = true;
+            return;
+        }
+        m_rules[m_count++] = &rule;
+    }
+
+    // Nothing failed yet.
+    bool empty() const noexcept { return m_count == 0; }
+
+    // Only meaningful if !empty(). A stream position (see get_pos()).
+    std::size_t farthest() const noexcept { return m_farthest; }
+
+    // The rules expected at farthest(), in the order they failed.
+    RuleInfo const *const *begin() const noexcept { return m_rules.data(); }
+    RuleInfo const *const *end() const noexcept {
+        return m_rules.data() + m_count;
+    }
+    std::size_t size() const noexcept { return m_count; }
+    bool        truncated() const noexcept { return m_truncated; }
+
+    // Forget earlier failures, e.g. before reusing a stream for
+    // another top-level parse. Tracking stays enabled.
+    void reset() noexcept {
+        m_farthest  = 0;
+        m_count     = 0;
+        m_seen      = 0;
+        m_truncated = false;
+    }
+
+private:
+    bool contains(RuleInfo const *rule) const noexcept {
+        for (std::size_t i = 0; i < m_count; ++i) {
+            if (m_rules[i] == rule) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::size_t                    m_farthest{0};
+    std::size_t                    m_count{0};
+    std::uint64_t                  m_seen{0}; // bits id % 64 of m_rules
+    bool                           m_truncated{false};
+    bool                           m_enabled{false};
+    std::array<RuleInfo const *, max_expected> m_rules{};
+};
+
+/**
+ * Why a parse failed: where the farthest failure happened and what
+ * would have let it go further. line and column are 1-based, the
+ * column counted in chars.
+ *
+ * Only as good as the stream's FailureSet: unless
+ * context().failures().enable() was called before parsing, nothing
+ * was recorded, and the error is placed where the parse stopped with
+ * no expectations ("line 1, column 1: syntax error" for a parse that
+ * backtracked to the start).
+ */
+struct ParseError {
+    std::size_t                   offset{0};
+    std::size_t                   line{1};
+    std::size_t                   column{1};
+    std::vector<std::string_view> expected;
+
+    // "line 3, column 7: expected 'x' or \"if\""
+    std::string message() const {
+        std::string ret = "line " + std::to_string(line) + ", column " +
+                          std::to_string(column) + ": ";
+        if (expected.empty()) {
+            return ret + "syntax error";
+        }
+        ret += "expected ";
+        for (std::size_t i = 0; i < expected.size(); ++i) {
+            if (i) {
+                ret += i + 1 == expected.size() ? " or " : ", ";
+            }
+            ret += expected[i];
+        }
+        return ret;
+    }
+};
+
+// Error for the failures in f, where prefix is the text from the start
+// of the input up to the farthest failure. f must have been enabled
+// before the parse (see ParseError).
+template<typename T>
+ParseError parse_error(std::basic_string_view<T> prefix, FailureSet const &f) {
+    ParseError e;
+    e.offset = prefix.size();
+    for (T c : prefix) {
+        if (c == T('\n')) {
+            ++e.line;
+            e.column = 1;
+        } else {
+            ++e.column;
+        }
+    }
+    for (auto const *rule : f) {
+        e.expected.push_back(rule->name);
+    }
+    return e;
+}
+
+CPPEG_NAMESPACE_CLOSE
+
+#endif
@@ -1,40 +1,79 @@
 #ifndef CPPEG_INPUT_STREAM_HPP
 #define CPPEG_INPUT_STREAM_HPP
 
+#include "arena.hpp"
+#include "assertions.hpp"
 #include "cppeg_common.hpp"
-#include <locale>
+#include "parse_context.hpp"
+#include "whitespace.hpp"
+#include <array>
+#include <cstring>
+#include <optional>
 #include <string_view>
-#include <vector>
+#include <type_traits>
 
 CPPEG_NAMESPACE_OPEN
 
 // who are we kidding, we're only using chars here...
-template<typename T = char>
+//
+// Skip is the policy deciding which chars rules never see (see
+// whitespace.hpp). The default keeps the historical runtime flag;
+// fixing it at compile time (NoSkip, SkipWhitespace, SkipRule)
+// removes the per-read check.
+//
+// Results is the policy for containers and strings in parse results
+// (see arena.hpp): HeapResults, or ArenaResults to allocate them from
+// context().arena().
+template<typename T = char, typename Skip = RuntimeWhitespace,
+         typename Results = HeapResults>
 class InputStream {
 
 public:
-    InputStream(std::basic_string_view<T> text, bool ignore_whitespace = 0)
-        : m_text(text), m_ignore_whitespace(ignore_whitespace) {}
+    using results_policy = Results;
 
-    void push() { m_pos_stack.push_back(m_pos); }
+    // With the default policy, `skip` may simply be the old
+    // ignore_whitespace bool.
+    InputStream(std::basic_string_view<T> text, Skip skip = Skip{})
+        : m_text(text), m_skip(std::move(skip)) {}
 
-    void pop() { m_pos_stack.pop_back(); }
+    using checkpoint_type = std::size_t;
 
-    void pop_reset() {
-        m_pos = m_pos_stack.back();
-        m_pos_stack.pop_back();
+    // Backtracking support. A checkpoint is a plain value held by the
+    // caller (see Rule::parse): restore() seeks back to it and commit()
+    // does nothing, so positions from get_pos() may be restored too.
+    checkpoint_type checkpoint() const noexcept { return m_pos; }
+
+    void commit(checkpoint_type) noexcept {}
+
+    void restore(checkpoint_type cp) noexcept { m_pos = cp; }
+
+    // Rule::parse brackets each checkpoint it holds with these (see
+    // detail::CheckpointScope), in LIFO order. Only the number of live
+    // ones and the outermost are tracked, for low_water().
+    void enter_checkpoint(checkpoint_type cp) noexcept {
+        if (m_depth++ == 0) {
+            m_anchor = cp;
+        }
+    }
+
+    void leave_checkpoint() noexcept {
+        debug_assert(m_depth > 0, "leave_checkpoint without a matching enter");
+        --m_depth;
+    }
+
+    // The parse can never be reset to a position before this one. Used
+    // to drop cached state that can no longer be reached (MemoRule).
+    std::size_t low_water() const noexcept {
+        return m_depth ? m_anchor : m_pos;
     }
 
     // Get the next char and advance the iterator, advancing past
     // whitespace if set to do so. m_text[m_pos] will *not*
     // equal the first returned value upon repeated calls.
     T getChar() {
-        const auto N = m_text.size();
-        while (m_pos < N) {
-            auto C = m_text[m_pos++];
-            if (!m_ignore_whitespace || !std::isspace(C)) {
-                return C;
-            }
+        m_pos = skip_from(m_pos);
+        if (m_pos < m_text.size()) {
+            return m_text[m_pos++];
         }
         return T{-1}; // probably an invalid char. can be checked for.
     }
@@ -43,17 +82,50 @@ public:
     // if set to do so. m_text[m_pos] will continue to equal
     // the first returned value upon repeated calls.
     T peekChar() {
-        const auto N = m_text.size();
-        while (m_pos < N) {
-            auto C = m_text[m_pos];
-            if (!m_ignore_whitespace || !std::isspace(C)) {
-                return C;
-            }
-            ++m_pos;
+        m_pos = skip_from(m_pos);
+        if (m_pos < m_text.size()) {
+            return m_text[m_pos];
         }
         return T{-1};
     }
 
+    // Consume the next char if pred accepts it. On rejection the
+    // stream is left untouched, including any whitespace that would
+    // have been skipped, so a failed match needs no checkpoint.
+    template<typename Pred>
+    std::optional<T> next_if(Pred &&pred) {
+        auto p = skip_from(m_pos);
+        if (p < m_text.size() && pred(m_text[p])) {
+            m_pos = p + 1;
+            return m_text[p];
+        }
+        return std::nullopt;
+    }
+
+    // Consume s if the upcoming chars equal it. Same all-or-nothing
+    // behaviour as next_if.
+    bool match(std::basic_string_view<T> s) {
+        auto p = skip_from(m_pos);
+        if (m_text.substr(p, s.size()) == s) {
+            m_pos = p + s.size();
+            return true;
+        }
+        return false;
+    }
+
+    // match() for a literal whose length is a compile-time constant,
+    // so the comparison can be done with a few word-sized loads.
+    template<std::size_t N>
+    bool match(std::array<T, N> const &s) {
+        auto p = skip_from(m_pos);
+        if (m_text.size() - p >= N &&
+            std::memcmp(m_text.data() + p, s.data(), N * sizeof(T)) == 0) {
+            m_pos = p + N;
+            return true;
+        }
+        return false;
+    }
+
     // Sometimes useful when checking has been
     // done on the other end.
     void advance_n_unchecked(int n) {
@@ -68,18 +140,59 @@ public:
 
     //Distance to end. Not for utf-8
     auto distance_to_end() const { return m_text.size() - m_pos; }
+
+    // View of (up to) the next n chars, without advancing. Shorter
+    // than n only when the end of input is reached.
+    std::basic_string_view<T> lookahead(std::size_t n) const {
+        return m_text.substr(m_pos, n);
+    }
+
+    // View of the input between two positions (as from get_pos()).
+    // Points into the original text, so it lives as long as that does.
+    std::basic_string_view<T> span(std::size_t from, std::size_t to) const {
+        return m_text.substr(from, to - from);
+    }
     
-    auto get_ignore_state() const noexcept { return m_ignore_whitespace; }
-    void set_ignore_state(bool val) noexcept { m_ignore_whitespace = val; }
+    // Only available with the RuntimeWhitespace policy.
+    template<typename S>
+    using if_runtime_skip =
+        std::enable_if_t<std::is_same_v<S, RuntimeWhitespace>>;
+
+    template<typename S = Skip, typename = if_runtime_skip<S>>
+    auto get_ignore_state() const noexcept { return m_skip.ignore; }
+    template<typename S = Skip, typename = if_runtime_skip<S>>
+    void set_ignore_state(bool val) noexcept { m_skip.ignore = val; }
+
     auto get_pos() const noexcept { return m_pos; }
 
+    // Position of the first char at or after p that is not skipped.
+    std::size_t skip_from(std::size_t p) const { return m_skip.skip(m_text, p); }
+
+    // Per-parse state used by rules such as PackratRule.
+    ParseContext &context() noexcept { return m_context; }
+
 private:
-    std::vector<std::size_t>  m_pos_stack;
+
     std::basic_string_view<T> m_text;
     std::size_t               m_pos{0};
-    bool                      m_ignore_whitespace;
+    std::size_t               m_anchor{0}; // outermost live checkpoint
+    std::size_t               m_depth{0};  // number of live checkpoints
+    Skip                      m_skip;
+    ParseContext              m_context;
 };
 
+// Error for a failed parse of in (or of a MappedInputStream). Failures
+// are noted where the failing rule started, before the whitespace it
+// skipped, so the error is placed past that whitespace. Without
+// in.context().failures().enable() before the parse there are none,
+// and the error only says where the parse stopped.
+template<typename T, typename Skip, typename Results>
+ParseError parse_error(InputStream<T, Skip, Results> &in) {
+    auto const &f = in.context().failures();
+    auto pos = in.skip_from(f.empty() ? in.get_pos() : f.farthest());
+    return parse_error(in.span(0, pos), f);
+}
+
 CPPEG_NAMESPACE_CLOSE
 
 #endif
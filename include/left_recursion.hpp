@@ -0,0 +1,98 @@
+#ifndef CPPEG_LEFT_RECURSION_HPP
+#define CPPEG_LEFT_RECURSION_HPP
+
+#include "cppeg_common.hpp"
+#include "input_stream.hpp"
+#include "rule.hpp"
+#include "rule_ref.hpp"
+
+#include <optional>
+#include <type_traits>
+
+CPPEG_NAMESPACE_OPEN
+
+/**
+ * A named rule that may refer to itself, including as its own first
+ * element (direct left recursion):
+ *
+ *     LeftRecursive<long> expr;
+ *     expr.define((expr + Char<'-'> + num)[subtract] | num);
+ *
+ * Left recursion is resolved by seed growing (Warth et al., "Packrat
+ * Parsers Can Support Left Recursion"): the first call at a position
+ * records a failure for the handle there, then re-parses the body as
+ * long as each attempt gets further than the previous one, with the
+ * inner self-reference replaying the last result. Results are thus
+ * left-associative, and each operand is parsed once per growth step.
+ * The results are kept in the stream's PackratTable.
+ *
+ * The body is held by a RuleRef, with the same ownership rules and
+ * result conversion. Only direct left recursion is supported, and
+ * memoized rules inside the body may record results computed from an
+ * incomplete seed.
+ */
+template<typename Result, typename Stream = InputStream<>>
+class LeftRecursive : public Rule<LeftRecursive<Result, Stream>> {
+public:
+    template<typename R>
+    void define(Rule<R> const &r) {
+        m_body.define(r);
+    }
+
+    // Seed growing restores the start itself; see below.
+    static constexpr bool restores_on_failure = true;
+
+    template<typename S>
+    std::optional<Result> parse_impl(S &in) {
+        static_assert(std::is_same_v<S, Stream>,
+                      "LeftRecursive parses only the Stream type it was "
+                      "declared with");
+
+        auto &entries = in.context()
+                            .packrat()
+                            .template entries<std::optional<Result>>(
+                                m_body.id());
+        auto start = in.get_pos();
+
+        auto it = entries.find(start);
+        if (it != entries.end()) {
+            in.advance_n_unchecked(it->second.end - start);
+            return detail::results_policy_t<S>::copy(in, it->second.result);
+        }
+
+        // Seed: a failure, so the left-recursive alternative fails and
+        // the others provide the first result.
+        auto &seed = entries[start];
+        seed.end   = start;
+
+        auto cp = in.checkpoint();
+        {
+            // Every round restarts from the start.
+            detail::CheckpointScope<S> scope(in, cp);
+            for (;;) {
+                auto ans = m_body.parse(in);
+                auto end = in.get_pos();
+                if (!ans || (seed.result && end <= seed.end)) {
+                    break;
+                }
+                seed.result = std::move(ans);
+                seed.end    = end;
+                in.restore(cp);
+                cp = in.checkpoint();
+            }
+            in.restore(cp);
+        }
+
+        if (seed.result) {
+            in.advance_n_unchecked(seed.end - start);
+        }
+        return detail::results_policy_t<S>::copy(in, seed.result);
+    }
+
+private:
+    RuleRef<Result, Stream> m_body;
+};
+
+CPPEG_NAMESPACE_CLOSE
+
+#endif
@@ -0,0 +1,339 @@
+#ifndef CPPEG_LITERAL_SET_HPP
+#define CPPEG_LITERAL_SET_HPP
+
+#include "basic_rules.hpp"
+#include "cppeg_common.hpp"
+#include "rule.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+CPPEG_NAMESPACE_OPEN
+
+// Result of a LiteralSet: which literal matched (its position in the
+// set) and the input it matched.
+template<typename View>
+struct LiteralMatch {
+    std::size_t index;
+    View        span;
+
+    bool operator==(LiteralMatch const &o) const {
+        return index == o.index && span == o.span;
+    }
+};
+
+enum class LiteralSetMode {
+    first,  // the first literal in set order that matches, as with |
+    longest // the longest literal that matches
+};
+
+/**
+ * Matches one of a set of literals in a single pass over the input,
+ * walking a trie built when the set is created, instead of comparing
+ * each literal in turn. Alternations of literals fold into one:
+ *
+ *   auto kw = "select"_L | "insert"_L | "update"_L; // LiteralSet<>
+ *
+ * In the default (first) mode this picks the same literal the OrRule
+ * it replaces would have; with LiteralSetMode::longest ("in" vs
+ * "insert") the longest match wins. Either way the result is the
+ * matched literal's index plus a view of the matched input, which
+ * lives as long as the stream's text (a copy on StreamingInputStream,
+ * whose buffer moves as it reads). On wide streams the literals are
+ * compared as StaticLiteral compares its chars.
+ *
+ * Copies share the literals and the trie, which is built on the first
+ * parse.
+ */
+template<LiteralSetMode Mode = LiteralSetMode::first>
+class LiteralSet : public Rule<LiteralSet<Mode>> {
+public:
+    LiteralSet(std::vector<std::string> literals)
+        : m_shared(std::make_shared<Shared>()) {
+        m_shared->literals = std::move(literals);
+    }
+    LiteralSet(std::initializer_list<std::string> literals)
+        : LiteralSet(std::vector<std::string>(literals)) {}
+
+    static constexpr bool reports_failure = true;
+
+    // One name for the set; the literals are only known at run time.
+    static constexpr std::string_view expected_name() { return "literal"; }
+
+    template<typename Stream>
+    auto parse_impl(Stream &in) {
+        using view_type = decltype(in.span(0, 0));
+        std::optional<LiteralMatch<view_type>> ret;
+
+        auto const &t = trie();
+
+        in.peekChar(); // skip leading whitespace, if any
+        auto start = in.get_pos();
+        auto text  = in.lookahead(t.max_length);
+        using T    = typename decltype(text)::value_type;
+
+        auto best     = no_literal;
+        auto best_len = std::size_t{0};
+        auto node     = std::uint32_t{0};
+        for (std::size_t i = 0;; ++i) {
+            auto const &n = t.nodes[node];
+            if (takes_over(n.literal, best)) {
+                best     = n.literal;
+                best_len = i;
+            }
+            if (i == text.size() || !worth_descending(n, best)) {
+                break;
+            }
+            // A wide char only matches the char converting to it, as
+            // StaticLiteral compares them; others are in no literal.
+            auto c = text[i];
+            if constexpr (sizeof(T) > 1) {
+                if (T(static_cast<char>(c)) != c) {
+                    break;
+                }
+            }
+            node = next(t, node, static_cast<unsigned char>(c));
+            if (node == no_node) {
+                break;
+            }
+        }
+
+        if (best != no_literal) {
+            in.advance_n_unchecked(static_cast<int>(best_len));
+            ret = LiteralMatch<view_type>{best,
+                                          in.span(start, start + best_len)};
+        }
+        return ret;
+    }
+
+    std::vector<std::string> const &literals() const noexcept {
+        return m_shared->literals;
+    }
+
+    // The literals, moved out when no copy shares them, as when |
+    // adds to a set that | just made. The set is not used afterwards.
+    std::vector<std::string> release_literals() && {
+        if (m_shared.use_count() == 1) {
+            return std::move(m_shared->literals);
+        }
+        return m_shared->literals;
+    }
+
+private:
+    static constexpr std::uint32_t no_node    = ~std::uint32_t{0};
+    static constexpr std::uint32_t no_literal = ~std::uint32_t{0};
+
+    // Edges of a node are the range [first_edge, first_edge +
+    // edge_count) of labels/targets, sorted by label.
+    struct Node {
+        std::uint32_t first_edge{0};
+        std::uint32_t edge_count{0};
+        std::uint32_t literal{no_literal};    // first literal ending here
+        std::uint32_t best_below{no_literal}; // lowest index in subtree
+    };
+
+    struct Trie {
+        std::vector<Node>              nodes;
+        std::vector<unsigned char>     labels;
+        std::vector<std::uint32_t>     targets;
+        std::array<std::uint32_t, 256> root; // edges of node 0, by char
+        std::size_t                    max_length{0};
+    };
+
+    // Shared by copies. The trie is built on the first parse, not
+    // when the set is made, so a chain a | b | c ... builds it once.
+    struct Shared {
+        std::vector<std::string> literals;
+        std::atomic<bool>        built{false};
+        std::once_flag           once;
+        Trie                     trie;
+    };
+
+    // Threads parsing with copies of one set build the trie only once.
+    Trie const &trie() const {
+        auto &s = *m_shared;
+        if (!s.built.load(std::memory_order_acquire)) {
+            std::call_once(s.once, [&s] {
+                build(s.literals, s.trie);
+                s.built.store(true, std::memory_order_release);
+            });
+        }
+        return s.trie;
+    }
+
+    // Whether the literal ending at the current node (the longest so
+    // far) replaces the best match: in first mode the lowest index
+    // wins, in longest mode any literal does.
+    static bool takes_over(std::uint32_t literal, std::uint32_t best) {
+        if constexpr (Mode == LiteralSetMode::first) {
+            return literal < best;
+        } else {
+            (void)best;
+            return literal != no_literal;
+        }
+    }
+
+    static bool worth_descending(Node const &n, std::uint32_t best) {
+        if constexpr (Mode == LiteralSetMode::first) {
+            return n.best_below < best;
+        } else {
+            (void)best;
+            return n.best_below != no_literal;
+        }
+    }
+
+    static std::uint32_t next(Trie const &t, std::uint32_t node,
+                              unsigned char c) {
+        if (node == 0) {
+            return t.root[c];
+        }
+        auto const &n = t.nodes[node];
+        for (auto e = n.first_edge; e < n.first_edge + n.edge_count; ++e) {
+            if (t.labels[e] == c) {
+                return t.targets[e];
+            }
+        }
+        return no_node;
+    }
+
+    static void build(std::vector<std::string> const &literals, Trie &t) {
+        // A map-based trie first, flattened breadth-first below.
+        struct BuildNode {
+            std::map<unsigned char, std::size_t> next;
+            std::uint32_t                        literal{no_literal};
+        };
+        std::vector<BuildNode> tmp(1);
+        for (std::size_t i = 0; i < literals.size(); ++i) {
+            std::size_t n = 0;
+            for (char ch : literals[i]) {
+                auto c  = static_cast<unsigned char>(ch);
+                auto it = tmp[n].next.find(c);
+                if (it == tmp[n].next.end()) {
+                    tmp.emplace_back();
+                    it = tmp[n].next.emplace(c, tmp.size() - 1).first;
+                }
+                n = it->second;
+            }
+            if (tmp[n].literal == no_literal) {
+                tmp[n].literal = static_cast<std::uint32_t>(i);
+            }
+            t.max_length = std::max(t.max_length, literals[i].size());
+        }
+
+        std::vector<std::uint32_t> order{0}; // build node by flat index
+        std::vector<std::uint32_t> flat(tmp.size());
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            for (auto const &[c, child] : tmp[order[i]].next) {
+                flat[child] = static_cast<std::uint32_t>(order.size());
+                order.push_back(static_cast<std::uint32_t>(child));
+            }
+        }
+
+        t.nodes.resize(order.size());
+        t.root.fill(no_node);
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            auto const &b = tmp[order[i]];
+            auto &      n = t.nodes[i];
+            n.literal     = b.literal;
+            n.first_edge  = static_cast<std::uint32_t>(t.labels.size());
+            n.edge_count  = static_cast<std::uint32_t>(b.next.size());
+            for (auto const &[c, child] : b.next) {
+                t.labels.push_back(c);
+                t.targets.push_back(flat[child]);
+                if (i == 0) {
+                    t.root[c] = flat[child];
+                }
+            }
+        }
+
+        // Children come after their parent, so a reverse pass sees
+        // every subtree complete.
+        for (std::size_t i = t.nodes.size(); i-- > 0;) {
+            auto &n      = t.nodes[i];
+            n.best_below = n.literal;
+            for (auto e = n.first_edge; e < n.first_edge + n.edge_count; ++e) {
+                n.best_below =
+                    std::min(n.best_below, t.nodes[t.targets[e]].best_below);
+            }
+        }
+    }
+
+    std::shared_ptr<Shared> m_shared;
+};
+
+// Longest-match version of a set: longest("in"_L | "insert"_L).
+inline LiteralSet<LiteralSetMode::longest>
+longest(LiteralSet<> const &set) {
+    return LiteralSet<LiteralSetMode::longest>(set.literals());
+}
+
+namespace detail {
+
+// Rules that | folds into a LiteralSet, and the literals they add.
+template<typename R>
+struct is_literal_rule : std::false_type {};
+template<>
+struct is_literal_rule<Literal> : std::true_type {};
+template<>
+struct is_literal_rule<LiteralView> : std::true_type {};
+template<char... Cs>
+struct is_literal_rule<StaticLiteral<Cs...>> : std::true_type {};
+template<>
+struct is_literal_rule<LiteralSet<>> : std::true_type {};
+
+inline void append_literals(std::vector<std::string> &out, Literal const &r) {
+    out.push_back(r.text());
+}
+inline void append_literals(std::vector<std::string> &out,
+                            LiteralView const &r) {
+    out.push_back(r.text());
+}
+template<char... Cs>
+void append_literals(std::vector<std::string> &out,
+                     StaticLiteral<Cs...> const &) {
+    out.push_back(std::string{Cs...});
+}
+inline void append_literals(std::vector<std::string> &out,
+                            LiteralSet<> const &r) {
+    out.insert(out.end(), r.literals().begin(), r.literals().end());
+}
+
+// The literals of the left operand of |, where a chain a | b | c ...
+// grows: those of a set made by the previous | are moved, not copied.
+template<typename R>
+std::vector<std::string> first_literals(R const &r) {
+    std::vector<std::string> out;
+    append_literals(out, r);
+    return out;
+}
+inline std::vector<std::string> first_literals(LiteralSet<> &&r) {
+    return std::move(r).release_literals();
+}
+
+} // end namespace detail
+
+template<typename L, typename R,
+         typename = std::enable_if_t<
+             detail::is_literal_rule<std::decay_t<L>>::value &&
+             detail::is_literal_rule<R>::value>>
+LiteralSet<> operator|(L &&lhs, R const &rhs) {
+    auto literals = detail::first_literals(std::forward<L>(lhs));
+    detail::append_literals(literals, rhs);
+    return LiteralSet<>(std::move(literals));
+}
+
+CPPEG_NAMESPACE_CLOSE
+
+#endif
@@ -0,0 +1,131 @@
+#ifndef CPPEG_MAPPED_INPUT_STREAM_HPP
+#define CPPEG_MAPPED_INPUT_STREAM_HPP
+
+#include "cppeg_common.hpp"
+#include "input_stream.hpp"
+
+#include <cerrno>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+CPPEG_NAMESPACE_OPEN
+
+/**
+ * Read-only memory mapping of a whole file. The mapping is
+ * released when the object is destroyed. Throws std::system_error
+ * if the file cannot be opened or mapped.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(std::string const &path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), path);
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            int err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::generic_category(), path);
+        }
+
+        m_size = static_cast<std::size_t>(st.st_size);
+        if (m_size == 0) {
+            // mmap refuses zero-length mappings. An empty view is fine.
+            ::close(fd);
+            return;
+        }
+
+        void *p = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        int   err = errno;
+        ::close(fd); // the mapping keeps its own reference to the file
+        if (p == MAP_FAILED) {
+            throw std::system_error(err, std::generic_category(), path);
+        }
+        m_data = p;
+
+        // Parsers mostly walk forward, so ask for aggressive readahead.
+        // Both calls are hints only; failures are not errors.
+        ::madvise(m_data, m_size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+        ::madvise(m_data, m_size, MADV_HUGEPAGE);
+#endif
+    }
+
+    MappedFile(MappedFile const &) = delete;
+    MappedFile &operator=(MappedFile const &) = delete;
+
+    MappedFile(MappedFile &&other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr)),
+          m_size(std::exchange(other.m_size, 0)) {}
+
+    MappedFile &operator=(MappedFile &&other) noexcept {
+        if (this != &other) {
+            unmap();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+        }
+        return *this;
+    }
+
+    ~MappedFile() { unmap(); }
+
+    void const *data() const noexcept { return m_data; }
+    std::size_t size() const noexcept { return m_size; }
+
+    template<typename T = char>
+    std::basic_string_view<T> view() const noexcept {
+        return std::basic_string_view<T>(static_cast<T const *>(m_data),
+                                         m_size / sizeof(T));
+    }
+
+private:
+    void unmap() noexcept {
+        if (m_data) {
+            ::munmap(m_data, m_size);
+            m_data = nullptr;
+        }
+    }
+
+    void *      m_data{nullptr};
+    std::size_t m_size{0};
+};
+
+/**
+ * An InputStream over a memory-mapped file. The file contents are
+ * never copied: the underlying InputStream views the mapping directly,
+ * so every rule that accepts an InputStream<T> works unchanged.
+ *
+ * MappedFile is a (private) base rather than a member so that the
+ * mapping exists before the InputStream base is constructed. Skip and
+ * Results are passed on to it.
+ */
+template<typename T = char, typename Skip = RuntimeWhitespace,
+         typename Results = HeapResults>
+class MappedInputStream : private MappedFile,
+                          public InputStream<T, Skip, Results> {
+public:
+    explicit MappedInputStream(std::string const &path, Skip skip = Skip{})
+        : MappedFile(path),
+          InputStream<T, Skip, Results>(MappedFile::view<T>(),
+                                        std::move(skip)) {}
+
+    // Moving is safe: the mapping itself never relocates, so the
+    // view held by the InputStream base stays valid.
+    MappedInputStream(MappedInputStream &&) noexcept = default;
+    MappedInputStream &operator=(MappedInputStream &&) = delete;
+
+    std::size_t file_size() const noexcept { return MappedFile::size(); }
+};
+
+CPPEG_NAMESPACE_CLOSE
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef CPPEG_MEMO_HPP
+#define CPPEG_MEMO_HPP
+
+#include "compound_rules.hpp"
+#include "arena.hpp"
+#include "cppeg_common.hpp"
+#include "memo_table.hpp"
+#include "rule.hpp"
+
+#include <cstdint>
+#include <type_traits>
+
+CPPEG_NAMESPACE_OPEN
+
+/**
+ * Packrat memoization of a subrule. The first parse at a position is
+ * recorded in the stream's PackratTable; later attempts at the same
+ * position (typically from an OrRule backtracking over alternatives
+ * that share a prefix) replay the result and end position instead of
+ * parsing again. Wrapping every rule that can be re-tried this way
+ * makes the whole parse linear in the input size, at the cost of one
+ * table entry per (rule, position) visited.
+ *
+ * The table keeps its own copies of the results (on the heap); a
+ * replay copies one out with the stream's results policy, so with
+ * ArenaResults it lands on the arena like a fresh parse.
+ */
+template<typename R>
+class PackratRule : public Rule<PackratRule<R>> {
+
+public:
+    PackratRule(const Rule<R> &r)
+        : subrule(r.self()), id(detail::next_memo_id()) {}
+
+    // The subrule rewinds itself; a replayed failure never moved.
+    static constexpr bool restores_on_failure = true;
+
+    // Rejecting still costs a table lookup.
+    static constexpr detail::FirstSet first_set() {
+        auto f         = detail::first_set_of<R>;
+        f.cheap_reject = false;
+        return f;
+    }
+
+    template<typename Stream>
+    auto parse_impl(Stream &in) {
+        using result_type = std::decay_t<decltype(subrule.parse(in))>;
+
+        auto &entries =
+            in.context().packrat().template entries<result_type>(id);
+        auto start = in.get_pos();
+
+        auto it = entries.find(start);
+        if (it != entries.end()) {
+            in.advance_n_unchecked(it->second.end - start);
+            return detail::results_policy_t<Stream>::copy(in,
+                                                          it->second.result);
+        }
+
+        auto ret = subrule.parse(in);
+        entries.emplace(start,
+                        detail::MemoEntry<result_type>{ret, in.get_pos()});
+        return ret;
+    }
+
+private:
+    R           subrule;
+    std::size_t id;
+};
+
+template<typename R>
+auto packrat(const Rule<R> &r) {
+    return PackratRule<R>(r);
+}
+
+//======================================================================
+
+namespace detail {
+
+// One per rule type; its address identifies stateless memoized rules.
+template<typename R>
+alignas(2) inline constexpr char memo_tag = 0;
+
+// A rule is stateless when every instance of its type parses alike:
+// empty leaf rules, and compound rules built only from those.
+template<typename R>
+struct is_stateless : std::bool_constant<std::is_empty_v<R>> {};
+template<typename... Rs>
+struct is_stateless<AndRule<Rs...>>
+    : std::conjunction<is_stateless<Rs>...> {};
+template<typename... Rs>
+struct is_stateless<OrRule<Rs...>>
+    : std::conjunction<is_stateless<Rs>...> {};
+template<typename R, typename F>
+struct is_stateless<CallbackRule<R, F>>
+    : std::bool_constant<is_stateless<R>::value && std::is_empty_v<F>> {};
+template<typename R>
+struct is_stateless<DiscardRule<R>> : is_stateless<R> {};
+template<typename R>
+struct is_stateless<SpanRule<R>> : is_stateless<R> {};
+template<typename R, std::size_t Min, std::size_t Max>
+struct is_stateless<RepeatRule<R, Min, Max>> : is_stateless<R> {};
+
+} // end namespace detail
+
+/**
+ * Selective memoization with bounded memory: like PackratRule, but
+ * results go to the stream's fixed-capacity FlatMemoTable (see
+ * ParseContext::set_memo_capacity), so memory does not grow with
+ * input size times the number of rules. Wrap only the rules that are
+ * actually re-tried.
+ *
+ * A stateless rule (built only from empty rules such as Char,
+ * CharClass or Lit) is keyed by its type alone, so every instance
+ * shares its entries. Rules holding state (Literal, callbacks with
+ * captures) get a key at creation, shared by copies.
+ */
+template<typename R>
+class MemoRule : public Rule<MemoRule<R>> {
+
+public:
+    MemoRule(const Rule<R> &r) : subrule(r.self()), key(make_key()) {}
+
+    static constexpr bool restores_on_failure = true;
+
+    // Rejecting still costs a table lookup.
+    static constexpr detail::FirstSet first_set() {
+        auto f         = detail::first_set_of<R>;
+        f.cheap_reject = false;
+        return f;
+    }
+
+    template<typename Stream>
+    auto parse_impl(Stream &in) {
+        using result_type = std::decay_t<decltype(subrule.parse(in))>;
+        using table_type  = FlatMemoTable<result_type>;
+
+        auto start = in.get_pos();
+        if (start >= table_type::max_pos) {
+            return subrule.parse(in); // beyond 32-bit positions
+        }
+
+        auto &table = in.context().template memo_table<result_type>();
+        auto  pos   = static_cast<std::uint32_t>(start);
+
+        if (auto hit = table.find(key, pos)) {
+            in.advance_n_unchecked(hit->end - pos);
+            return detail::results_policy_t<Stream>::copy(in, hit->result);
+        }
+
+        auto ret = subrule.parse(in);
+        auto end = in.get_pos();
+        if (end < table_type::max_pos) {
+            table.insert(key, pos, static_cast<std::uint32_t>(end), ret,
+                         in.low_water());
+        }
+        return ret;
+    }
+
+private:
+    static std::uintptr_t make_key() {
+        if constexpr (detail::is_stateless<R>::value) {
+            return reinterpret_cast<std::uintptr_t>(&detail::memo_tag<R>);
+        } else {
+            // odd, so it can never equal a (2-aligned) tag address
+            return (detail::next_memo_id() << 1) | 1;
+        }
+    }
+
+    R              subrule;
+    std::uintptr_t key;
+};
+
+template<typename R>
+auto memo(const Rule<R> &r) {
+    return MemoRule<R>(r);
+}
+
+CPPEG_NAMESPACE_CLOSE
+
+#endif
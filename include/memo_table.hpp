@@ -0,0 +1,189 @@
+#ifndef CPPEG_MEMO_TABLE_HPP
+#define CPPEG_MEMO_TABLE_HPP
+
+#include "cppeg_common.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+CPPEG_NAMESPACE_OPEN
+
+namespace detail {
+
+// What a memoized rule produced at some position: its full parse result
+// (success or failure) and where the stream ended up.
+template<typename Result>
+struct MemoEntry {
+    Result      result;
+    std::size_t end;
+};
+
+// Identity for a memoized rule, handed out when it is created and
+// shared by its copies (compound rules store their subrules by value).
+inline std::size_t next_memo_id() {
+    static std::atomic<std::size_t> counter{0};
+    return counter.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // end namespace detail
+
+/**
+ * Packrat cache: for every memoized rule, the results it produced,
+ * keyed by start position. Since a table belongs to a single stream,
+ * a given rule always stores the same Result type in it.
+ */
+class PackratTable {
+public:
+    template<typename Result>
+    using entry_map = std::unordered_map<std::size_t, detail::MemoEntry<Result>>;
+
+    template<typename Result>
+    entry_map<Result> &entries(std::size_t rule_id) {
+        auto &slot = m_slots[rule_id];
+        if (!slot) {
+            slot = std::make_unique<Slot<Result>>();
+        }
+        return static_cast<Slot<Result> &>(*slot).entries;
+    }
+
+    void clear() { m_slots.clear(); }
+
+private:
+    struct SlotBase {
+        virtual ~SlotBase() = default;
+    };
+
+    template<typename Result>
+    struct Slot : SlotBase {
+        entry_map<Result> entries;
+    };
+
+    std::unordered_map<std::size_t, std::unique_ptr<SlotBase>> m_slots;
+};
+
+//--------------------------------------------------------------------------
+
+namespace detail {
+
+struct FlatMemoTableBase {
+    virtual ~FlatMemoTableBase() = default;
+};
+
+// Small dense index per Result type, so a ParseContext can find the
+// table for a type with a vector lookup.
+inline std::size_t next_memo_type_index() {
+    static std::atomic<std::size_t> counter{0};
+    return counter.fetch_add(1, std::memory_order_relaxed);
+}
+
+template<typename Result>
+std::size_t memo_type_index() {
+    static const std::size_t index = next_memo_type_index();
+    return index;
+}
+
+} // end namespace detail
+
+/**
+ * Fixed-capacity memo table for MemoRule: a flat, open-addressing hash
+ * table of (rule key, 32-bit position) -> (result, end position), with
+ * one table per Result type. Nothing is allocated after construction.
+ *
+ * Inserting into a full probe window evicts, in order of preference,
+ * an entry behind the stream's low water mark (the parse can never
+ * return there), then the entry in the home slot. Eviction only costs
+ * a re-parse, never correctness.
+ */
+template<typename Result>
+class FlatMemoTable : public detail::FlatMemoTableBase {
+public:
+    static constexpr std::uint32_t max_pos =
+        std::numeric_limits<std::uint32_t>::max();
+
+    // capacity is rounded up to a power of two
+    explicit FlatMemoTable(std::size_t capacity) {
+        std::size_t n = 1;
+        while (n < capacity) {
+            n <<= 1;
+        }
+        m_slots.resize(n);
+        m_mask = n - 1;
+    }
+
+    struct Slot {
+        std::uintptr_t key{0}; // 0: empty
+        std::uint32_t  pos{0};
+        std::uint32_t  end{0};
+        Result         result{};
+    };
+
+    Slot const *find(std::uintptr_t key, std::uint32_t pos) const {
+        auto home = hash(key, pos);
+        for (std::size_t i = 0; i < probe_limit; ++i) {
+            auto const &s = m_slots[(home + i) & m_mask];
+            if (s.key == key && s.pos == pos) {
+                return &s;
+            }
+            if (s.key == 0) {
+                return nullptr;
+            }
+        }
+        return nullptr;
+    }
+
+    void insert(std::uintptr_t key, std::uint32_t pos, std::uint32_t end,
+                Result const &result, std::size_t low_water) {
+        auto  home   = hash(key, pos);
+        Slot *target = nullptr;
+        for (std::size_t i = 0; i < probe_limit; ++i) {
+            auto &s = m_slots[(home + i) & m_mask];
+            if (s.key == 0 || (s.key == key && s.pos == pos)) {
+                target = &s;
+                break;
+            }
+            if (!target && s.pos < low_water) {
+                target = &s;
+            }
+        }
+        if (!target) {
+            target = &m_slots[home & m_mask];
+        }
+        target->key    = key;
+        target->pos    = pos;
+        target->end    = end;
+        target->result = result;
+    }
+
+    std::size_t capacity() const noexcept { return m_slots.size(); }
+
+    // Number of occupied slots (linear scan; for tests and statistics).
+    std::size_t size() const noexcept {
+        std::size_t n = 0;
+        for (auto const &s : m_slots) {
+            n += (s.key != 0);
+        }
+        return n;
+    }
+
+private:
+    static constexpr std::size_t probe_limit = 8;
+
+    std::size_t hash(std::uintptr_t key, std::uint32_t pos) const noexcept {
+        std::uint64_t h = (static_cast<std::uint64_t>(key) ^
+                           (static_cast<std::uint64_t>(pos) << 32 | pos)) *
+                          0x9E3779B97F4A7C15ull;
+        return static_cast<std::size_t>(h >> 32);
+    }
+
+    std::vector<Slot> m_slots;
+    std::size_t       m_mask;
+};
+
+CPPEG_NAMESPACE_CLOSE
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "cppeg_common.hpp"
 #include <optional>
+#include <string_view>
 #include <variant>
 #include <type_traits>
 
@@ -57,6 +58,21 @@ template<typename T>
 constexpr bool is_optional_v = is_optional<T>::value;
 
 
+//-------------------------------------------------------------------
+template<typename T>
+struct is_string_view {
+    constexpr static bool value = false;
+};
+
+template<typename T>
+struct is_string_view<std::basic_string_view<T>> {
+    constexpr static bool value = true;
+};
+
+template<typename T>
+constexpr bool is_string_view_v = is_string_view<T>::value;
+
+
 } // end namespace meta
 
 CPPEG_NAMESPACE_CLOSE
@@ -0,0 +1,270 @@
+#ifndef CPPEG_PARALLEL_HPP
+#define CPPEG_PARALLEL_HPP
+
+#include "arena.hpp"
+#include "cppeg_common.hpp"
+#include "input_stream.hpp"
+#include "rule.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+CPPEG_NAMESPACE_OPEN
+
+namespace detail {
+
+// Chunks handed out per worker thread, so one slow chunk does not hold
+// up the others, and the smallest chunk worth a hand-off.
+inline constexpr std::size_t chunks_per_thread = 8;
+inline constexpr std::size_t min_chunk_bytes   = std::size_t{1} << 14;
+
+// How far (in chunks per worker) the workers may run ahead of the
+// chunk the sink is on, which bounds the results held for it.
+inline constexpr std::size_t chunks_ahead_per_thread = 2;
+
+template<typename R, typename Stream>
+using record_result_t =
+    decltype(std::declval<R &>().parse(std::declval<Stream &>()));
+
+// Splits text into at most n pieces of about equal size, each ending
+// just after a delimiter (the last one at the end of text), so no
+// record straddles two pieces.
+inline std::vector<std::string_view>
+split_chunks(std::string_view text, char delimiter, std::size_t n) {
+    std::vector<std::string_view> chunks;
+    auto target = std::max(text.size() / std::max<std::size_t>(n, 1),
+                           min_chunk_bytes);
+    std::size_t begin = 0;
+    while (begin < text.size()) {
+        std::size_t end = text.size();
+        if (text.size() - begin > target) {
+            auto p = text.find(delimiter, begin + target - 1);
+            if (p != std::string_view::npos) {
+                end = p + 1;
+            }
+        }
+        chunks.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+    return chunks;
+}
+
+// Calls f on each record of chunk, without its delimiter. A delimiter
+// at the very end does not start another (empty) record.
+template<typename F>
+void for_each_record(std::string_view chunk, char delimiter, F &&f) {
+    while (!chunk.empty()) {
+        auto p = static_cast<char const *>(
+            std::memchr(chunk.data(), delimiter, chunk.size()));
+        if (!p) {
+            f(chunk);
+            return;
+        }
+        auto n = static_cast<std::size_t>(p - chunk.data());
+        f(chunk.substr(0, n));
+        chunk.remove_prefix(n + 1);
+    }
+}
+
+// The rule's result on one record, which it must match in full
+// (trailing skipped chars aside); a failed result otherwise.
+template<typename Stream, typename R>
+record_result_t<R, Stream> parse_record(R &rule, std::string_view record) {
+    static_assert(std::is_same_v<results_policy_t<Stream>, HeapResults>,
+                  "parse_records: results outlive each record's stream, "
+                  "so they cannot be on its arena");
+    Stream in(record);
+    auto   ret = rule.parse(in);
+    in.peekChar();
+    if (in.distance_to_end() != 0) {
+        ret = decltype(ret){};
+    }
+    return ret;
+}
+
+} // end namespace detail
+
+/**
+ * Parses delimiter-separated records (e.g. the lines of a log file) on
+ * several threads:
+ *
+ *     auto line = span(+~NotCharClass<CharRule<' '>>{}) + ...;
+ *     auto rows = parse_records<InputStream<char, NoSkip>>(line, text);
+ *
+ * The input is cut into chunks at delimiters, and each worker parses
+ * whole chunks with its own copy of the grammar and one Stream per
+ * record, so records must be independent of each other. A record's
+ * result is that of the grammar, or a failed one (nullopt, or
+ * monostate for an OrRule) if it does not match the whole record.
+ *
+ * With a sink, each (record, result) pair is passed to
+ * sink(std::string_view, Result &&) on the calling thread, in input
+ * order, as soon as the chunks before it are done. Workers stay a few
+ * chunks ahead of the sink, so a slow sink holds them up rather than
+ * letting results pile up. Without one, the results are returned in
+ * input order.
+ *
+ * threads == 0 uses one thread per core. Grammars are stateless (see
+ * ParseContext), but callbacks run on the workers, so any state they
+ * capture must be safe to share. An exception thrown by a callback
+ * stops the parse and is rethrown here.
+ */
+template<typename Stream = InputStream<>, typename R, typename Sink,
+         typename = std::enable_if_t<std::is_invocable_v<
+             Sink &, std::string_view,
+             detail::record_result_t<R, Stream> &&>>>
+void parse_records(Rule<R> const &grammar, std::string_view input,
+                   Sink &&sink, char delimiter = '\n',
+                   unsigned threads = 0) {
+    using result_type = detail::record_result_t<R, Stream>;
+    using batch_type  = std::vector<std::pair<std::string_view, result_type>>;
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    auto chunks =
+        detail::split_chunks(input, delimiter,
+                             std::size_t{threads} * detail::chunks_per_thread);
+    auto workers = std::min<std::size_t>(threads, chunks.size());
+
+    if (workers <= 1) {
+        R rule = grammar.self();
+        for (auto chunk : chunks) {
+            detail::for_each_record(chunk, delimiter, [&](std::string_view r) {
+                sink(r, detail::parse_record<Stream>(rule, r));
+            });
+        }
+        return;
+    }
+
+    struct Batch {
+        batch_type results;
+        bool       done{false};
+    };
+    std::vector<Batch>       batches(chunks.size());
+    std::atomic<std::size_t> next{0};
+    std::mutex               mutex;
+    std::condition_variable  ready; // a batch is done
+    std::condition_variable  room;  // the sink moved on
+    std::size_t              sinking{0}; // batch the sink is on
+    bool                     stop{false};
+    std::exception_ptr       error;
+
+    auto const window = workers * detail::chunks_ahead_per_thread;
+
+    auto work = [&] {
+        R rule = grammar.self();
+        for (std::size_t i; (i = next.fetch_add(1)) < chunks.size();) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                room.wait(lock, [&] { return i < sinking + window || stop; });
+                if (stop) {
+                    return;
+                }
+            }
+            batch_type results;
+            try {
+                detail::for_each_record(
+                    chunks[i], delimiter, [&](std::string_view r) {
+                        results.emplace_back(
+                            r, detail::parse_record<Stream>(rule, r));
+                    });
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                next.store(chunks.size());
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                batches[i].results = std::move(results);
+                batches[i].done    = true;
+            }
+            ready.notify_all();
+        }
+    };
+
+    // Stops handing out chunks and waits for the workers, also when
+    // the sink throws.
+    struct Join {
+        std::vector<std::thread> &threads;
+        std::atomic<std::size_t> &next;
+        std::size_t               end;
+        std::mutex               &mutex;
+        std::condition_variable  &room;
+        bool                     &stop;
+        ~Join() {
+            next.store(end);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stop = true;
+            }
+            room.notify_all();
+            for (auto &t : threads) {
+                t.join();
+            }
+        }
+    };
+
+    {
+        std::vector<std::thread> pool;
+        Join join{pool, next, chunks.size(), mutex, room, stop};
+        pool.reserve(workers);
+        for (std::size_t t = 0; t < workers; ++t) {
+            pool.emplace_back(work);
+        }
+
+        for (std::size_t k = 0; k < batches.size(); ++k) {
+            auto      &batch = batches[k];
+            batch_type results;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [&] { return batch.done || error; });
+                if (error) {
+                    break;
+                }
+                results.swap(batch.results);
+                sinking = k;
+            }
+            room.notify_all();
+            for (auto &[record, result] : results) {
+                sink(record, std::move(result));
+            }
+        }
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+template<typename Stream = InputStream<>, typename R>
+std::vector<detail::record_result_t<R, Stream>>
+parse_records(Rule<R> const &grammar, std::string_view input,
+              char delimiter = '\n', unsigned threads = 0) {
+    using result_type = detail::record_result_t<R, Stream>;
+
+    std::vector<result_type> results;
+    parse_records<Stream>(
+        grammar, input,
+        [&](std::string_view, result_type &&r) {
+            results.push_back(std::move(r));
+        },
+        delimiter, threads);
+    return results;
+}
+
+CPPEG_NAMESPACE_CLOSE
+
+#endif
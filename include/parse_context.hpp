@@ -0,0 +1,78 @@
+#ifndef CPPEG_PARSE_CONTEXT_HPP
+#define CPPEG_PARSE_CONTEXT_HPP
+
+#include "arena.hpp"
+#include "cppeg_common.hpp"
+#include "failure.hpp"
+#include "memo_table.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+CPPEG_NAMESPACE_OPEN
+
+/**
+ * Per-parse state that some rules attach to the input stream
+ * (available as stream.context()). Grammars themselves stay stateless,
+ * so one grammar object can drive many streams.
+ */
+class ParseContext {
+public:
+    // Farthest failure so far, for error reporting (see failure.hpp).
+    FailureSet &failures() noexcept { return m_failures; }
+
+    // Used by PackratRule (see memo.hpp).
+    PackratTable &packrat() noexcept { return m_packrat; }
+
+    // Used by MemoRule (see memo.hpp). One table per result type,
+    // created on first use with memo_capacity() slots.
+    template<typename Result>
+    FlatMemoTable<Result> &memo_table() {
+        auto index = detail::memo_type_index<Result>();
+        if (index >= m_memo_tables.size()) {
+            m_memo_tables.resize(index + 1);
+        }
+        auto &table = m_memo_tables[index];
+        if (!table) {
+            table = std::make_unique<FlatMemoTable<Result>>(m_memo_capacity);
+        }
+        return static_cast<FlatMemoTable<Result> &>(*table);
+    }
+
+    static constexpr std::size_t default_memo_capacity = 4096;
+
+    // Slots per result type. Applies to tables not created yet, so set
+    // it before parsing.
+    void set_memo_capacity(std::size_t slots) { m_memo_capacity = slots; }
+    std::size_t memo_capacity() const noexcept { return m_memo_capacity; }
+
+    // Memory for results, with the ArenaResults policy (see arena.hpp).
+    // The context's own is created on first use and freed with it.
+    Arena &arena() {
+        if (!m_arena) {
+            m_owned_arena = std::make_unique<Arena>();
+            m_arena       = m_owned_arena.get();
+        }
+        return *m_arena;
+    }
+
+    // Allocate results from a if given, e.g. one arena reused (and
+    // released) across documents; it must outlive the results. Set it
+    // before parsing.
+    void set_arena(Arena &a) noexcept { m_arena = &a; }
+
+private:
+    FailureSet   m_failures;
+    PackratTable m_packrat;
+
+    std::vector<std::unique_ptr<detail::FlatMemoTableBase>> m_memo_tables;
+    std::size_t m_memo_capacity{default_memo_capacity};
+
+    std::unique_ptr<Arena> m_owned_arena;
+    Arena *                m_arena{nullptr};
+};
+
+CPPEG_NAMESPACE_CLOSE
+
+#endif
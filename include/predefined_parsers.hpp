@@ -0,0 +1,363 @@
+#ifndef CPPEG_PREDEFINED_PARSERS_HPP
+#define CPPEG_PREDEFINED_PARSERS_HPP
+
+#include "char_table.hpp"
+#include "cppeg_common.hpp"
+#include "rule.hpp"
+
+#include <cerrno>
+#include <cfloat>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+CPPEG_NAMESPACE_OPEN
+
+namespace detail {
+
+inline constexpr bool is_decimal_digit(char c) { return c >= '0' && c <= '9'; }
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+inline constexpr bool swar_digits = true;
+#else
+inline constexpr bool swar_digits = false;
+#endif
+
+// SWAR ("SIMD within a register") digit decoding: eight ASCII chars
+// loaded as one little-endian word are checked and converted with a
+// handful of integer operations instead of eight multiply-adds.
+inline std::uint64_t load_eight_chars(char const *p) {
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof v);
+    return v;
+}
+
+inline bool is_eight_digits(std::uint64_t v) {
+    // Each byte must be 0x30..0x39: high nibble 3, and adding 6 must
+    // not carry into the high nibble.
+    return ((v & 0xF0F0F0F0F0F0F0F0u) |
+            (((v + 0x0606060606060606u) & 0xF0F0F0F0F0F0F0F0u) >> 4)) ==
+           0x3333333333333333u;
+}
+
+inline std::uint32_t eight_digits_value(std::uint64_t v) {
+    constexpr std::uint64_t mask = 0x000000FF000000FFu;
+    constexpr std::uint64_t mul1 = 100 + (std::uint64_t{1000000} << 32);
+    constexpr std::uint64_t mul2 = 1 + (std::uint64_t{10000} << 32);
+    v -= 0x3030303030303030u;
+    v = (v * 10) + (v >> 8); // pairs of digits
+    v = (((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32;
+    return static_cast<std::uint32_t>(v);
+}
+
+// acc = acc * mul + add, unless that exceeds U; then sets overflow.
+template<typename U>
+void mul_add(U &acc, U mul, U add, bool &overflow) {
+    if (acc > (std::numeric_limits<U>::max() - add) / mul) {
+        overflow = true;
+    } else {
+        acc = acc * mul + add;
+    }
+}
+
+// Appends the run of decimal digits at p to acc and returns the first
+// char after it. If acc would overflow, sets overflow and keeps
+// scanning (acc is then meaningless).
+template<typename U>
+char const *read_digits(char const *p, char const *end, U &acc,
+                        bool &overflow) {
+    if constexpr (swar_digits) {
+        while (end - p >= 8) {
+            auto v = load_eight_chars(p);
+            if (!is_eight_digits(v)) {
+                break;
+            }
+            mul_add(acc, U{100000000}, U{eight_digits_value(v)}, overflow);
+            p += 8;
+        }
+    }
+    while (p != end && is_decimal_digit(*p)) {
+        mul_add(acc, U{10}, static_cast<U>(*p - '0'), overflow);
+        ++p;
+    }
+    return p;
+}
+
+// Length of the integer at the start of [s, end), with its value in
+// out; 0 if there is none or it does not fit T.
+template<typename T>
+std::size_t scan_integer(char const *s, char const *end, T &out) {
+    // Wide enough for every T; 64 bits for the usual ones.
+    using acc_type = std::conditional_t<(sizeof(T) > sizeof(std::uint64_t)),
+                                        std::make_unsigned_t<T>,
+                                        std::uint64_t>;
+    using unsigned_type = std::make_unsigned_t<T>;
+
+    char const *p   = s;
+    bool        neg = false;
+    if constexpr (std::is_signed_v<T>) {
+        if (p != end && *p == '-') {
+            neg = true;
+            ++p;
+        }
+    }
+
+    char const *digits   = p;
+    acc_type    acc      = 0;
+    bool        overflow = false;
+    p                    = read_digits(p, end, acc, overflow);
+    if (p == digits || overflow) {
+        return 0;
+    }
+
+    constexpr auto max = static_cast<acc_type>(std::numeric_limits<T>::max());
+    if (neg) {
+        if (acc > max + 1) {
+            return 0;
+        }
+        out = static_cast<T>(static_cast<unsigned_type>(0 - acc));
+    } else {
+        if (acc > max) {
+            return 0;
+        }
+        out = static_cast<T>(acc);
+    }
+    return static_cast<std::size_t>(p - s);
+}
+
+// Clinger's fast path: a decimal with a mantissa of at most
+// max_mantissa and |exponent| <= max_exponent is exactly m * 10^e or
+// m / 10^-e, both operands being exact, so one IEEE operation rounds
+// correctly. Only valid without excess precision (FLT_EVAL_METHOD 0).
+template<typename F>
+struct fast_path;
+
+template<>
+struct fast_path<double> {
+    static constexpr std::uint64_t max_mantissa = std::uint64_t{1} << 53;
+    static constexpr int           max_exponent = 22;
+    static constexpr double        powers[]     = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+};
+
+template<>
+struct fast_path<float> {
+    static constexpr std::uint64_t max_mantissa = std::uint64_t{1} << 24;
+    static constexpr int           max_exponent = 10;
+    static constexpr float         powers[]     = {
+        1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+};
+
+// Correctly rounded conversion of a span already checked by
+// scan_float. std::from_chars where the library has it for floats
+// (libstdc++ 12 and later implement it with Eisel-Lemire).
+template<typename F>
+bool convert_float(char const *s, char const *end, F &out) {
+#if defined(__cpp_lib_to_chars)
+    auto r = std::from_chars(s, end, out);
+    return r.ec == std::errc() && r.ptr == end;
+#else
+    std::string buf(s, end);
+    char       *stop = nullptr;
+    errno            = 0;
+    if constexpr (std::is_same_v<F, float>) {
+        out = std::strtof(buf.c_str(), &stop);
+    } else {
+        out = std::strtod(buf.c_str(), &stop);
+    }
+    return errno != ERANGE && stop == buf.c_str() + buf.size();
+#endif
+}
+
+// Length of the decimal number at the start of [s, end), with its
+// value in out; 0 if there is none or it is out of F's range.
+template<typename F>
+std::size_t scan_float(char const *s, char const *end, F &out) {
+    char const *p   = s;
+    bool        neg = p != end && *p == '-';
+    if (neg) {
+        ++p;
+    }
+
+    // Digits of the integer and fraction parts, as one integer.
+    std::uint64_t mantissa = 0;
+    bool          overflow = false;
+    std::int64_t  exponent = 0;
+
+    char const *int_part = p;
+    p = read_digits(p, end, mantissa, overflow);
+    bool any_digits = p != int_part;
+
+    if (p != end && *p == '.') {
+        char const *fraction = p + 1;
+        char const *q        = read_digits(fraction, end, mantissa, overflow);
+        if (q != fraction) {
+            exponent   = -(q - fraction);
+            any_digits = true;
+            p          = q;
+        }
+    }
+    if (!any_digits) {
+        return 0;
+    }
+
+    // The exponent is taken only if it has digits, so "2e" is 2.
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        char const *q       = p + 1;
+        bool        neg_exp = false;
+        if (q != end && (*q == '+' || *q == '-')) {
+            neg_exp = *q == '-';
+            ++q;
+        }
+        if (q != end && is_decimal_digit(*q)) {
+            std::int64_t e = 0;
+            for (; q != end && is_decimal_digit(*q); ++q) {
+                if (e < 100000) { // far beyond any finite result
+                    e = e * 10 + (*q - '0');
+                }
+            }
+            exponent += neg_exp ? -e : e;
+            p = q;
+        }
+    }
+
+#if FLT_EVAL_METHOD == 0
+    using fast = fast_path<F>;
+    if (!overflow && mantissa <= fast::max_mantissa &&
+        exponent >= -fast::max_exponent && exponent <= fast::max_exponent) {
+        F v = static_cast<F>(mantissa);
+        v   = exponent < 0 ? v / fast::powers[-exponent]
+                           : v * fast::powers[exponent];
+        out = neg ? -v : v;
+        return static_cast<std::size_t>(p - s);
+    }
+#endif
+
+    if (!convert_float(s, p, out)) {
+        return 0;
+    }
+    return static_cast<std::size_t>(p - s);
+}
+
+// Runs scan(view) on a window of upcoming chars, doubling it while the
+// match might continue past its end (the scanners look at most 2
+// chars beyond their match, e.g. "1e+" before a digit). Windowing
+// keeps a StreamingInputStream from reading ahead more than needed.
+template<typename Stream, typename Scan>
+std::size_t scan_window(Stream &in, Scan &&scan) {
+    std::size_t n = 64;
+    while (true) {
+        auto text = in.lookahead(n);
+        auto len  = scan(text.data(), text.data() + text.size());
+        if (text.size() < n || len + 3 <= text.size()) {
+            return len;
+        }
+        n *= 2;
+    }
+}
+
+} // end namespace detail
+
+/**
+ * A decimal integer of type T, read straight into its value:
+ * digits with an optional leading '-' if T is signed (no '+', as with
+ * std::from_chars). A number that does not fit T does not match, and
+ * consumes nothing. Digits are decoded eight at a time (SWAR) where
+ * the platform is little-endian.
+ *
+ *   auto port = Char<':'> + Int<std::uint16_t>;   // ":8080" -> 8080
+ */
+template<typename T>
+struct IntRule : public Rule<IntRule<T>> {
+    static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>,
+                  "IntRule: T must be an integer type");
+
+    // Leading whitespace is skipped before the number is looked at, so
+    // unlike the char rules this one keeps Rule::parse's checkpoint.
+    static constexpr bool reports_failure = true;
+
+    static constexpr std::string_view expected_name() {
+        return std::is_signed_v<T> ? "integer" : "unsigned integer";
+    }
+
+    static constexpr detail::FirstSet first_set() {
+        auto chars = detail::CharTable{}.set_range('0', '9');
+        if (std::is_signed_v<T>) {
+            chars.set('-');
+        }
+        return {chars, false, false};
+    }
+
+    template<typename Stream>
+    std::optional<T> parse_impl(Stream &in) {
+        in.peekChar(); // skip leading whitespace, if any
+        T    value{};
+        auto len = detail::scan_window(in, [&](char const *s, char const *e) {
+            return detail::scan_integer(s, e, value);
+        });
+        if (len == 0) {
+            return std::nullopt;
+        }
+        in.advance_n_unchecked(static_cast<int>(len));
+        return value;
+    }
+};
+
+template<typename T>
+constexpr IntRule<T> Int = IntRule<T>{};
+
+/**
+ * A decimal floating-point number, read straight into a float or
+ * double: an optional '-', digits with an optional fraction (".5" and
+ * "1.5", but not "1."), and an optional exponent. Values small enough
+ * to be exact take a fast path of one multiplication or division;
+ * the rest are converted by std::from_chars. Out of range numbers do
+ * not match.
+ *
+ *   auto point = Float<double> + ~Char<','> + Float<double>;
+ */
+template<typename F>
+struct FloatRule : public Rule<FloatRule<F>> {
+    static_assert(std::is_same_v<F, float> || std::is_same_v<F, double>,
+                  "FloatRule: F must be float or double");
+
+    static constexpr bool reports_failure = true; // see IntRule
+
+    static constexpr std::string_view expected_name() { return "number"; }
+
+    static constexpr detail::FirstSet first_set() {
+        auto chars = detail::CharTable{}.set_range('0', '9');
+        chars.set('-').set('.');
+        return {chars, false, false};
+    }
+
+    template<typename Stream>
+    std::optional<F> parse_impl(Stream &in) {
+        in.peekChar(); // skip leading whitespace, if any
+        F    value{};
+        auto len = detail::scan_window(in, [&](char const *s, char const *e) {
+            return detail::scan_float(s, e, value);
+        });
+        if (len == 0) {
+            return std::nullopt;
+        }
+        in.advance_n_unchecked(static_cast<int>(len));
+        return value;
+    }
+};
+
+template<typename F>
+constexpr FloatRule<F> Float = FloatRule<F>{};
+
+CPPEG_NAMESPACE_CLOSE
+
+#endif
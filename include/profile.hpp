@@ -0,0 +1,208 @@
+#ifndef CPPEG_PROFILE_HPP
+#define CPPEG_PROFILE_HPP
+
+#include "cppeg_common.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(CPPEG_PROFILE_CYCLES) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+CPPEG_NAMESPACE_OPEN
+
+/**
+ * Per-rule counters, filled in by Rule::parse when CPPEG_PROFILE is
+ * defined (it must be, consistently, for every translation unit of a
+ * program). Rules are keyed by helpers::type_name, or by the name
+ * given to named(). Positions are stream positions: bytes, or tokens
+ * on a TokenStream.
+ *
+ * With CPPEG_PROFILE_CYCLES, time spent in each rule (inclusive of its
+ * subrules, and counted again by each recursive call) is recorded too:
+ * rdtsc cycles on x86, nanoseconds elsewhere.
+ *
+ * Counters are not atomic: profile one parsing thread at a time.
+ */
+namespace profile {
+
+struct Counters {
+    std::string   name;
+    std::uint64_t calls{0};
+    std::uint64_t successes{0};
+    std::uint64_t failures{0};
+    std::uint64_t consumed{0};    // by successful calls
+    std::uint64_t backtracked{0}; // given back when the rule failed
+    std::uint64_t ticks{0};       // with CPPEG_PROFILE_CYCLES
+};
+
+inline std::uint64_t ticks() {
+#if defined(CPPEG_PROFILE_CYCLES)
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+#else
+    return 0;
+#endif
+}
+
+class Registry {
+public:
+    // The counters for name, created on first use. References stay
+    // valid for the life of the program.
+    Counters &counters(std::string_view name) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_by_name.find(name);
+        if (it != m_by_name.end()) {
+            return *it->second;
+        }
+        auto &c = m_counters.emplace_back();
+        c.name  = std::string(name);
+        m_by_name.emplace(c.name, &c);
+        return c;
+    }
+
+    // Zero every counter, keeping the rules registered.
+    void reset() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto &c : m_counters) {
+            c = Counters{std::move(c.name)};
+        }
+    }
+
+    // Counters of the rules called at least once, most called first.
+    std::vector<Counters> snapshot() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<Counters> ret;
+        for (auto const &c : m_counters) {
+            if (c.calls) {
+                ret.push_back(c);
+            }
+        }
+        std::stable_sort(ret.begin(), ret.end(),
+                         [](auto const &a, auto const &b) {
+                             return a.calls > b.calls;
+                         });
+        return ret;
+    }
+
+private:
+    mutable std::mutex                                  m_mutex;
+    std::deque<Counters>                                m_counters;
+    std::map<std::string_view, Counters *, std::less<>> m_by_name;
+};
+
+inline Registry &registry() {
+    static Registry r;
+    return r;
+}
+
+inline void reset() { registry().reset(); }
+
+// One line per rule. Long type names are cut to name_width chars.
+inline void report(std::ostream &os, std::size_t name_width = 48) {
+    auto cut = [&](std::string const &s) {
+        return s.size() <= name_width ? s : s.substr(0, name_width - 3) + "...";
+    };
+    char line[256];
+    std::snprintf(line, sizeof line, "%-*s %12s %12s %12s %12s %12s %14s\n",
+                  static_cast<int>(name_width), "rule", "calls", "successes",
+                  "failures", "consumed", "backtracked", "ticks");
+    os << line;
+    for (auto const &c : registry().snapshot()) {
+        std::snprintf(line, sizeof line,
+                      "%-*s %12llu %12llu %12llu %12llu %12llu %14llu\n",
+                      static_cast<int>(name_width), cut(c.name).c_str(),
+                      static_cast<unsigned long long>(c.calls),
+                      static_cast<unsigned long long>(c.successes),
+                      static_cast<unsigned long long>(c.failures),
+                      static_cast<unsigned long long>(c.consumed),
+                      static_cast<unsigned long long>(c.backtracked),
+                      static_cast<unsigned long long>(c.ticks));
+        os << line;
+    }
+}
+
+// A JSON array with one object per rule.
+inline void report_json(std::ostream &os) {
+    auto quoted = [&](std::string const &s) {
+        os << '"';
+        for (char c : s) {
+            if (c == '"' || c == '\\') {
+                os << '\\' << c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char esc[8];
+                std::snprintf(esc, sizeof esc, "\\u%04x", c);
+                os << esc;
+            } else {
+                os << c;
+            }
+        }
+        os << '"';
+    };
+    os << "[";
+    bool first = true;
+    for (auto const &c : registry().snapshot()) {
+        os << (first ? "\n  " : ",\n  ") << "{\"rule\": ";
+        quoted(c.name);
+        os << ", \"calls\": " << c.calls << ", \"successes\": " << c.successes
+           << ", \"failures\": " << c.failures
+           << ", \"consumed\": " << c.consumed
+           << ", \"backtracked\": " << c.backtracked
+           << ", \"ticks\": " << c.ticks << "}";
+        first = false;
+    }
+    os << "\n]\n";
+}
+
+// Times and counts one Rule::parse call.
+class Probe {
+public:
+    Probe(Counters &c, std::size_t start)
+        : m_counters(c), m_start(start), m_ticks(ticks()) {
+        ++m_counters.calls;
+    }
+
+    // On failure, pos is where the rule stopped before the stream was
+    // rewound to its start.
+    void finish(bool success, std::size_t pos) {
+        if (success) {
+            ++m_counters.successes;
+            m_counters.consumed += pos - m_start;
+        } else {
+            ++m_counters.failures;
+            m_counters.backtracked += pos - m_start;
+        }
+    }
+
+    ~Probe() {
+#if defined(CPPEG_PROFILE_CYCLES)
+        m_counters.ticks += ticks() - m_ticks;
+#endif
+    }
+
+private:
+    Counters     &m_counters;
+    std::size_t   m_start;
+    std::uint64_t m_ticks;
+};
+
+} // end namespace profile
+
+CPPEG_NAMESPACE_CLOSE
+
+#endif
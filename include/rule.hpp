@@ -2,12 +2,25 @@
 #define CPPEG_RULE_HPP
 
 #include "assertions.hpp"
+#include "char_table.hpp"
 #include "cppeg_common.hpp"
+#include "failure.hpp"
 #include "fwd_decls.hpp"
 #include "meta.hpp"
 #include <optional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <variant>
 
+#ifdef CPPEG_PROFILE
+#include "profile.hpp"
+#include "type_name.hpp"
+#define CPPEG_PROFILED(...) __VA_ARGS__
+#else
+#define CPPEG_PROFILED(...)
+#endif
+
 CPPEG_NAMESPACE_OPEN
 
 template<typename T>
@@ -22,30 +35,130 @@ bool parse_success(T const &x) {
     }
 }
 
+// The value carried by a successful parse result: the contents of an
+// optional, or the variant itself (OrRule).
+template<typename T>
+auto take_parse_value(T &&x) {
+    if constexpr (meta::is_optional_v<std::decay_t<T>>) {
+        return std::move(*x);
+    } else {
+        return std::decay_t<T>(std::forward<T>(x));
+    }
+}
+
+namespace detail {
+
+// R::first_set(), evaluated once per rule type. Compound rules combine
+// these rather than calling first_set() recursively, which would redo
+// shared subtrees at compile time.
+template<typename R>
+inline constexpr FirstSet first_set_of = R::first_set();
+
+template<typename Stream, typename = void>
+struct tracks_checkpoints : std::false_type {};
+
+template<typename Stream>
+struct tracks_checkpoints<
+    Stream, std::void_t<decltype(std::declval<Stream &>().enter_checkpoint(
+                std::declval<typename Stream::checkpoint_type>()))>>
+    : std::true_type {};
+
+// A checkpoint that is live for the lifetime of the scope, for streams
+// that track them (InputStream::enter_checkpoint); a no-op for others.
+template<typename Stream>
+class CheckpointScope {
+public:
+    CheckpointScope(Stream &in, typename Stream::checkpoint_type cp)
+        : m_in(in) {
+        if constexpr (tracks_checkpoints<Stream>::value) {
+            m_in.enter_checkpoint(cp);
+        }
+    }
+
+    CheckpointScope(CheckpointScope const &) = delete;
+    CheckpointScope &operator=(CheckpointScope const &) = delete;
+
+    ~CheckpointScope() {
+        if constexpr (tracks_checkpoints<Stream>::value) {
+            m_in.leave_checkpoint();
+        }
+    }
+
+private:
+    Stream &m_in;
+};
+
+} // end namespace detail
+
 template<typename R>
 struct Rule {
 
+    // True for rules that never consume input when they fail.
+    // parse() skips saving and restoring a checkpoint for them.
+    // Derived rules opt in by redeclaring it.
+    static constexpr bool restores_on_failure = false;
+
+    // True for terminals (char and literal rules, ...). parse() notes
+    // their failures in the stream's FailureSet, from which ParseError
+    // reports what was expected at the farthest failure.
+    static constexpr bool reports_failure = false;
+
+    // How a failure of the rule is described in a ParseError.
+    static constexpr std::string_view expected_name() {
+        return helpers::type_name<R>();
+    }
+
+    // What the rule can start with (see FirstSet). Rules that can tell
+    // redeclare it.
+    static constexpr detail::FirstSet first_set() {
+        return detail::FirstSet::unknown();
+    }
+
     // We're using Expression Templates...
     R &      self() { return static_cast<R &>(*this); }
     R const &self() const { return static_cast<R const &>(*this); }
 
-    // The actual workhorse function. Injects push/pop calls as appropriate.
+    // The actual workhorse function. Saves a checkpoint on the (C++) stack
+    // and restores it if the parse fails.
     // Returns a std::optional<...>, which is received from the
-    // self().parse_impl(...) call.
-    template<typename T>
-    auto parse(InputStream<T> &inputStream) {
-        inputStream.push(); // save current spot in stream
+    // self().parse_impl(...) call. Stream is InputStream<T> or anything
+    // else providing the same interface (e.g. StreamingInputStream).
+    template<typename Stream>
+    auto parse(Stream &inputStream) {
+        CPPEG_PROFILED(profile::Probe probe(self().profile_counters(),
+                                            inputStream.get_pos());)
+        if constexpr (R::restores_on_failure) {
+            auto ret = self().parse_impl(inputStream);
+            CPPEG_PROFILED(probe.finish(parse_success(ret),
+                                        inputStream.get_pos());)
+            if constexpr (R::reports_failure && detail::track_failures) {
+                if (!parse_success(ret)) {
+                    note_failure(inputStream);
+                }
+            }
+            return ret;
+        } else {
+            auto cp = inputStream.checkpoint(); // save current spot in stream
 
-        // pass the call through to the 'real' parser rule.
-        auto ret = self().parse_impl(inputStream);
+            // pass the call through to the 'real' parser rule.
+            auto ret = [&] {
+                detail::CheckpointScope<Stream> scope(inputStream, cp);
+                return self().parse_impl(inputStream);
+            }();
 
-        if (parse_success(ret)) {
-            inputStream.pop();
-        } else {
-            inputStream.pop_reset();
-        }
+            CPPEG_PROFILED(probe.finish(parse_success(ret),
+                                        inputStream.get_pos());)
+            if (parse_success(ret)) {
+                inputStream.commit(cp);
+            } else {
+                inputStream.restore(cp);
+                if constexpr (R::reports_failure && detail::track_failures) {
+                    note_failure(inputStream);
+                }
+            }
 
-        return ret;
+            return ret;
+        }
     }
 
     // attach a callback
@@ -53,6 +166,22 @@ struct Rule {
     auto operator[](F func) const {
         return CallbackRule<R, F>(*this, std::move(func));
     }
+
+#ifdef CPPEG_PROFILE
+    // Where parse() counts calls of this rule (see profile.hpp).
+    // NamedRule redeclares it.
+    profile::Counters &profile_counters() const {
+        static profile::Counters &c =
+            profile::registry().counters(helpers::type_name<R>());
+        return c;
+    }
+#endif
+
+private:
+    template<typename Stream>
+    static void note_failure(Stream &in) {
+        in.context().failures().note(in.get_pos(), rule_info<R>);
+    }
 };
 
 CPPEG_NAMESPACE_CLOSE
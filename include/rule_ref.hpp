@@ -0,0 +1,145 @@
+#ifndef CPPEG_RULE_REF_HPP
+#define CPPEG_RULE_REF_HPP
+
+#include "assertions.hpp"
+#include "cppeg_common.hpp"
+#include "input_stream.hpp"
+#include "memo_table.hpp"
+#include "meta.hpp"
+#include "rule.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <variant>
+
+CPPEG_NAMESPACE_OPEN
+
+namespace detail {
+
+// Converts a successful body result to the handle's Result: the
+// contents of an optional, or whichever alternative of an OrRule
+// variant matched.
+template<typename Result, typename T>
+std::optional<Result> to_result(T &&ret) {
+    if (!parse_success(ret)) {
+        return std::nullopt;
+    }
+    if constexpr (meta::is_optional_v<std::decay_t<T>>) {
+        return Result(std::move(*ret));
+    } else {
+        return std::visit(
+            [](auto &&v) -> std::optional<Result> {
+                using V = std::decay_t<decltype(v)>;
+                if constexpr (std::is_same_v<V, std::monostate>) {
+                    return std::nullopt;
+                } else {
+                    return Result(std::move(v));
+                }
+            },
+            std::move(ret));
+    }
+}
+
+// The rule a RuleRef was defined with, behind a function pointer so
+// the handle's type does not depend on it.
+template<typename Result, typename Stream>
+struct RuleBody {
+    RuleBody() = default;
+    RuleBody(RuleBody const &) = delete;
+    RuleBody &operator=(RuleBody const &) = delete;
+    ~RuleBody() { reset(); }
+
+    template<typename R>
+    R &set(R const &r) {
+        reset();
+        auto typed = new R(r);
+        rule       = typed;
+        parse = [](void *p, Stream &in) -> std::optional<Result> {
+            return to_result<Result>(static_cast<R *>(p)->parse(in));
+        };
+        destroy = [](void *p) { delete static_cast<R *>(p); };
+        return *typed;
+    }
+
+    void reset() {
+        if (destroy) {
+            destroy(rule);
+        }
+        rule    = nullptr;
+        parse   = nullptr;
+        destroy = nullptr;
+    }
+
+    std::size_t id{next_memo_id()};
+    void *      rule{nullptr};
+    std::optional<Result> (*parse)(void *, Stream &){nullptr};
+    void (*destroy)(void *){nullptr};
+};
+
+} // end namespace detail
+
+/**
+ * Forward-declarable named rule, for recursive grammars:
+ *
+ *     RuleRef<Json> value;
+ *     auto array = (Char<'['> + *(value + Char<','>)) + Char<']'>)[...];
+ *     auto &top  = value.define(array | object | string | number);
+ *
+ * The handle is a fixed, small type whatever its definition, so it can
+ * appear inside that definition. Parsing through it makes one call
+ * through a function pointer to the stored rule, converting the result
+ * to Result (for an OrRule, each alternative must convert); nothing is
+ * allocated per call. define() returns the stored rule with its full
+ * type, so code outside the recursion (e.g. the top-level parse) can
+ * call it directly and keep everything inlined; only the recursion
+ * points go through the handle.
+ *
+ * The handle owns its rule; copies (e.g. the ones embedded in the
+ * definition) only refer to it, so the original must outlive them.
+ */
+template<typename Result, typename Stream = InputStream<>>
+class RuleRef : public Rule<RuleRef<Result, Stream>> {
+    using body_type = detail::RuleBody<Result, Stream>;
+
+public:
+    RuleRef()
+        : m_owned(std::make_unique<body_type>()), m_body(m_owned.get()) {}
+    RuleRef(RuleRef const &other) : m_body(other.m_body) {}
+    RuleRef(RuleRef &&) = default;
+    RuleRef &operator=(RuleRef const &) = delete;
+
+    template<typename R>
+    R &define(Rule<R> const &r) {
+        return m_body->set(r.self());
+    }
+
+    bool defined() const noexcept { return m_body->parse != nullptr; }
+
+    // Shared by all copies; e.g. a key for per-rule parse state.
+    std::size_t id() const noexcept { return m_body->id; }
+
+    // The stored rule rewinds itself through its own Rule::parse.
+    static constexpr bool restores_on_failure = true;
+
+    template<typename S>
+    std::optional<Result> parse_impl(S &in) {
+        static_assert(std::is_same_v<S, Stream>,
+                      "RuleRef parses only the Stream type it was declared "
+                      "with");
+        if (!defined()) {
+            debug_assert(false, "RuleRef used before define()");
+            return std::nullopt;
+        }
+        return m_body->parse(m_body->rule, in);
+    }
+
+private:
+    std::unique_ptr<body_type> m_owned;
+    body_type *                m_body;
+};
+
+CPPEG_NAMESPACE_CLOSE
+
+#endif
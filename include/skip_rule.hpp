@@ -0,0 +1,180 @@
+#ifndef CPPEG_SKIP_RULE_HPP
+#define CPPEG_SKIP_RULE_HPP
+
+#include "cppeg_common.hpp"
+#include "input_stream.hpp"
+#include "parse_context.hpp"
+#include "rule.hpp"
+#include "whitespace.hpp"
+
+#include <array>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+
+CPPEG_NAMESPACE_OPEN
+
+namespace detail {
+
+// The stream a SkipRule runs its rule on: InputStream<T, NoSkip>'s
+// interface over the outer stream's text, but a plain position on the
+// stack and a borrowed ParseContext, so a skip builds nothing.
+template<typename T>
+class SkipStream {
+public:
+    SkipStream(std::basic_string_view<T> text, std::size_t pos,
+               ParseContext &context)
+        : m_text(text), m_pos(pos), m_start(pos), m_context(context) {}
+
+    using checkpoint_type = std::size_t;
+
+    checkpoint_type checkpoint() const noexcept { return m_pos; }
+    void            commit(checkpoint_type) noexcept {}
+    void            restore(checkpoint_type cp) noexcept { m_pos = cp; }
+
+    // This skip never goes back before its start. Later skips may, but
+    // MemoRule only uses it to pick which entries to replace, so they
+    // merely recompute what was dropped.
+    std::size_t low_water() const noexcept { return m_start; }
+
+    T getChar() {
+        return m_pos < m_text.size() ? m_text[m_pos++] : T{-1};
+    }
+    T peekChar() { return m_pos < m_text.size() ? m_text[m_pos] : T{-1}; }
+
+    template<typename Pred>
+    std::optional<T> next_if(Pred &&pred) {
+        if (m_pos < m_text.size() && pred(m_text[m_pos])) {
+            return m_text[m_pos++];
+        }
+        return std::nullopt;
+    }
+
+    bool match(std::basic_string_view<T> s) {
+        if (m_text.substr(m_pos, s.size()) == s) {
+            m_pos += s.size();
+            return true;
+        }
+        return false;
+    }
+
+    template<std::size_t N>
+    bool match(std::array<T, N> const &s) {
+        if (m_text.size() - m_pos >= N &&
+            std::memcmp(m_text.data() + m_pos, s.data(), N * sizeof(T)) == 0) {
+            m_pos += N;
+            return true;
+        }
+        return false;
+    }
+
+    void advance_n_unchecked(int n) { m_pos += n; }
+    auto distance_to_end() const { return m_text.size() - m_pos; }
+
+    std::basic_string_view<T> lookahead(std::size_t n) const {
+        return m_text.substr(m_pos, n);
+    }
+    std::basic_string_view<T> span(std::size_t from, std::size_t to) const {
+        return m_text.substr(from, to - from);
+    }
+
+    auto get_pos() const noexcept { return m_pos; }
+
+    ParseContext &context() noexcept { return m_context; }
+
+private:
+    std::basic_string_view<T> m_text;
+    std::size_t               m_pos;
+    std::size_t               m_start;
+    ParseContext             &m_context;
+};
+
+} // end namespace detail
+
+/**
+ * Skip policy (InputStream, StreamingInputStream) driven by a grammar
+ * rule, e.g. whitespace and comments. The rule is applied repeatedly,
+ * on a NoSkip view of the text, until it fails or stops making
+ * progress; whatever it matched is invisible to the rules of the main
+ * grammar.
+ *
+ *   auto ws = AnyChar<' ', '\n'>{} | comment;
+ *   InputStream<char, SkipRule<decltype(ws)>> S(text, skip_with(ws));
+ *
+ * The rule runs on a lightweight stream sharing one ParseContext
+ * across skips, so rules such as PackratRule keep their tables between
+ * them. That context assumes one text: the policy's stream's, which
+ * gets its own copy (copies start with an empty context). It lives as
+ * long as the stream, so a PackratRule in the skip rule grows with the
+ * text as it would in the main grammar; a MemoRule's table is bounded.
+ *
+ * T is the stream's char type: skip_with<wchar_t>(ws) for an
+ * InputStream<wchar_t, ...>.
+ */
+template<typename R, typename T = char>
+class SkipRule {
+public:
+    SkipRule(Rule<R> const &r) : m_rule(r.self()) {}
+
+    SkipRule(SkipRule const &other) : m_rule(other.m_rule) {}
+    SkipRule &operator=(SkipRule const &other) {
+        m_rule    = other.m_rule;
+        m_context = ParseContext{};
+        return *this;
+    }
+
+    std::size_t skip(std::basic_string_view<T> text, std::size_t pos) const {
+        detail::SkipStream<T> in(text, pos, m_context);
+        return skip_on(in);
+    }
+
+    // skip() for text that is not all in memory (StreamingInputStream):
+    // in is a stream without skipping, at the position to skip from,
+    // whose context() is this policy's. Returns the position after
+    // what was skipped.
+    template<typename Stream>
+    std::size_t skip_on(Stream &in) const {
+        // Usually there is nothing to skip, which the rule's first set
+        // often tells without running it.
+        constexpr auto first = detail::first_set_of<R>;
+        if constexpr (first.excludes_some_char()) {
+            auto next = in.lookahead(1);
+            if (next.empty() || !first.may_start_with(next[0])) {
+                return in.get_pos();
+            }
+        }
+
+        while (true) {
+            auto before = in.get_pos();
+            if (!parse_success(m_rule.parse(in)) || in.get_pos() == before) {
+                return in.get_pos();
+            }
+        }
+    }
+
+    ParseContext &context() const noexcept { return m_context; }
+
+private:
+    // Rule::parse is non-const, while skipping is logically const.
+    mutable R            m_rule;
+    mutable ParseContext m_context;
+};
+
+template<typename T = char, typename R>
+auto skip_with(Rule<R> const &r) {
+    return SkipRule<R, T>(r);
+}
+
+namespace detail {
+
+template<typename Skip>
+struct is_skip_rule : std::false_type {};
+template<typename R, typename T>
+struct is_skip_rule<SkipRule<R, T>> : std::true_type {};
+
+} // end namespace detail
+
+CPPEG_NAMESPACE_CLOSE
+
+#endif
@@ -0,0 +1,402 @@
+#ifndef CPPEG_STREAMING_INPUT_STREAM_HPP
+#define CPPEG_STREAMING_INPUT_STREAM_HPP
+
+#include "arena.hpp"
+#include "cppeg_common.hpp"
+#include "failure.hpp"
+#include "parse_context.hpp"
+#include "skip_rule.hpp"
+#include "whitespace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#include <unistd.h>
+
+CPPEG_NAMESPACE_OPEN
+
+/**
+ * An input stream for sources that are never fully in memory
+ * (pipes, sockets, ...). Text is pulled from a reader in fixed-size
+ * chunks on demand, and only the window starting at the oldest
+ * position the parse could still be reset to is kept. Once every
+ * checkpoint has been committed or restored, the consumed text is
+ * released on the next refill, so memory use is bounded by
+ * backtracking depth rather than by input size.
+ *
+ * Positions (get_pos()) are absolute offsets into the whole input.
+ * Views returned by lookahead() are only valid until the stream reads
+ * more input, which moves the buffer; span() therefore returns a copy,
+ * so the results of span(), LiteralSet and the like stay valid. The
+ * copy is a string of the Results policy (see arena.hpp), so with
+ * ArenaResults it is allocated from context().arena().
+ *
+ * Skip is the same policy as InputStream's (see whitespace.hpp). A
+ * SkipRule runs on the stream itself, so what it skips (a comment,
+ * say) may span refills; it stays buffered until the skip is done.
+ *
+ * While failures are tracked (see ParseError), the text from the
+ * farthest failure on is kept as well, for parse_error(); memory then
+ * grows if the parse goes on far past that failure.
+ */
+template<typename T = char, typename Skip = RuntimeWhitespace,
+         typename Results = HeapResults>
+class StreamingInputStream {
+
+public:
+    using results_policy = Results;
+
+    // Fill up to n chars at the pointer. Return the number of chars
+    // written, and 0 only at the end of input.
+    using reader_type = std::function<std::size_t(T *, std::size_t)>;
+
+    static constexpr std::size_t default_chunk_size = 64 * 1024;
+
+    // As for InputStream, with the default policy `skip` may simply be
+    // the old ignore_whitespace bool.
+    StreamingInputStream(reader_type reader, Skip skip = Skip{},
+                         std::size_t chunk_size = default_chunk_size)
+        : m_reader(std::move(reader)), m_chunk_size(chunk_size),
+          m_skip(std::move(skip)) {}
+
+    // Read from a file descriptor. The descriptor is not closed.
+    explicit StreamingInputStream(int fd, Skip skip = Skip{},
+                                  std::size_t chunk_size = default_chunk_size)
+        : StreamingInputStream(fd_reader(fd), std::move(skip), chunk_size) {}
+
+    using checkpoint_type = std::size_t;
+
+    // Unlike InputStream's, checkpoints here must be committed or
+    // restored in LIFO order: they decide how much text is kept, and
+    // checkpoints nest, so only the outermost one matters.
+    checkpoint_type checkpoint() noexcept {
+        if (m_depth++ == 0) {
+            m_anchor = m_pos;
+        }
+        return m_pos;
+    }
+
+    void commit(checkpoint_type) noexcept { --m_depth; }
+
+    void restore(checkpoint_type cp) noexcept {
+        m_pos = cp;
+        --m_depth;
+    }
+
+    // Same contract as InputStream::getChar
+    T getChar() {
+        m_pos = skip_from(m_pos);
+        if (available(1)) {
+            return m_buf[m_pos++ - m_base];
+        }
+        return T{-1};
+    }
+
+    // Same contract as InputStream::low_water
+    std::size_t low_water() const noexcept {
+        return m_depth ? m_anchor : m_pos;
+    }
+
+    // Same contract as InputStream::peekChar
+    T peekChar() {
+        m_pos = skip_from(m_pos);
+        if (available(1)) {
+            return m_buf[m_pos - m_base];
+        }
+        return T{-1};
+    }
+
+    // Same contract as InputStream::next_if
+    template<typename Pred>
+    std::optional<T> next_if(Pred &&pred) {
+        auto p = skip_from(m_pos);
+        if (available(p - m_pos + 1)) {
+            auto C = m_buf[p - m_base];
+            if (pred(C)) {
+                m_pos = p + 1;
+                return C;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Same contract as InputStream::match
+    bool match(std::basic_string_view<T> s) {
+        auto p = skip_from(m_pos);
+        if (!available(p - m_pos + s.size())) {
+            return false;
+        }
+        if (std::basic_string_view<T>(m_buf.data() + (p - m_base),
+                                      s.size()) == s) {
+            m_pos = p + s.size();
+            return true;
+        }
+        return false;
+    }
+
+    // Same contract as the InputStream overload
+    template<std::size_t N>
+    bool match(std::array<T, N> const &s) {
+        auto p = skip_from(m_pos);
+        if (available(p - m_pos + N) &&
+            std::memcmp(m_buf.data() + (p - m_base), s.data(),
+                        N * sizeof(T)) == 0) {
+            m_pos = p + N;
+            return true;
+        }
+        return false;
+    }
+
+    // Only valid for chars already made available by lookahead().
+    void advance_n_unchecked(int n) { m_pos += n; }
+
+    // View of (up to) the next n chars, reading more input if needed.
+    // Shorter than n only when the end of input is reached.
+    std::basic_string_view<T> lookahead(std::size_t n) {
+        available(n);
+        auto off = m_pos - m_base;
+        return std::basic_string_view<T>(m_buf.data() + off,
+                                         std::min(n, m_buf.size() - off));
+    }
+
+    // Copy of the input between two absolute positions. Both must still
+    // be buffered, i.e. not before the outermost live checkpoint. Not a
+    // view: results outlive the next refill, which moves the buffer.
+    auto span(std::size_t from, std::size_t to) {
+        using string = typename Results::template basic_string<T>;
+        return Results::template make<string>(
+            *this, m_buf.data() + (from - m_base), to - from);
+    }
+
+    bool at_end() { return !available(1); }
+
+    // Only available with the RuntimeWhitespace policy.
+    template<typename S>
+    using if_runtime_skip =
+        std::enable_if_t<std::is_same_v<S, RuntimeWhitespace>>;
+
+    template<typename S = Skip, typename = if_runtime_skip<S>>
+    auto get_ignore_state() const noexcept { return m_skip.ignore; }
+    template<typename S = Skip, typename = if_runtime_skip<S>>
+    void set_ignore_state(bool val) noexcept { m_skip.ignore = val; }
+
+    auto get_pos() const noexcept { return m_pos; }
+
+    // Per-parse state used by rules such as PackratRule.
+    ParseContext &context() noexcept { return m_context; }
+
+    // Number of chars currently held in memory.
+    std::size_t buffered() const noexcept { return m_buf.size(); }
+
+    // Same contract as InputStream::skip_from, for positions still
+    // buffered.
+    std::size_t skip_from(std::size_t p) {
+        if constexpr (std::is_same_v<Skip, NoSkip>) {
+            return p;
+        } else if constexpr (detail::is_skip_rule<Skip>::value) {
+            SkipView view(*this, p, m_skip.context());
+            return m_skip.skip_on(view);
+        } else {
+            // Other policies look at one char at a time, so they run
+            // over the buffered window, again from where they stopped
+            // after each refill.
+            while (buffered_to(p + 1)) {
+                auto window =
+                    std::basic_string_view<T>(m_buf.data(), m_buf.size());
+                p = m_base + m_skip.skip(window, p - m_base);
+                if (p - m_base < m_buf.size()) {
+                    break; // found a char not skipped inside the window
+                }
+            }
+            return p;
+        }
+    }
+
+    template<typename U, typename S, typename R>
+    friend ParseError parse_error(StreamingInputStream<U, S, R> &in);
+
+private:
+    // The stream a SkipRule runs its rule on: the same input with no
+    // skipping, from a position of its own. It reads more input as
+    // needed; the stream's position has not moved, so nothing it has
+    // seen is released until the skip is done.
+    class SkipView {
+    public:
+        SkipView(StreamingInputStream &s, std::size_t pos,
+                 ParseContext &context)
+            : m_s(s), m_pos(pos), m_start(pos), m_context(context) {}
+
+        using checkpoint_type = std::size_t;
+
+        checkpoint_type checkpoint() const noexcept { return m_pos; }
+        void            commit(checkpoint_type) noexcept {}
+        void            restore(checkpoint_type cp) noexcept { m_pos = cp; }
+
+        std::size_t low_water() const noexcept { return m_start; }
+
+        T getChar() { return ready(1) ? at(m_pos++) : T{-1}; }
+        T peekChar() { return ready(1) ? at(m_pos) : T{-1}; }
+
+        template<typename Pred>
+        std::optional<T> next_if(Pred &&pred) {
+            if (ready(1) && pred(at(m_pos))) {
+                return at(m_pos++);
+            }
+            return std::nullopt;
+        }
+
+        bool match(std::basic_string_view<T> s) {
+            if (ready(s.size()) && lookahead(s.size()) == s) {
+                m_pos += s.size();
+                return true;
+            }
+            return false;
+        }
+
+        template<std::size_t N>
+        bool match(std::array<T, N> const &s) {
+            return match(std::basic_string_view<T>(s.data(), N));
+        }
+
+        void advance_n_unchecked(int n) { m_pos += n; }
+
+        std::basic_string_view<T> lookahead(std::size_t n) {
+            ready(n);
+            auto off = m_pos - m_s.m_base;
+            return std::basic_string_view<T>(
+                m_s.m_buf.data() + off, std::min(n, m_s.m_buf.size() - off));
+        }
+
+        std::basic_string<T> span(std::size_t from, std::size_t to) const {
+            return std::basic_string<T>(m_s.m_buf.data() + (from - m_s.m_base),
+                                        to - from);
+        }
+
+        auto get_pos() const noexcept { return m_pos; }
+
+        ParseContext &context() noexcept { return m_context; }
+
+    private:
+        bool ready(std::size_t n) { return m_s.buffered_to(m_pos + n); }
+        T    at(std::size_t p) const { return m_s.m_buf[p - m_s.m_base]; }
+
+        StreamingInputStream &m_s;
+        std::size_t           m_pos;
+        std::size_t           m_start;
+        ParseContext         &m_context;
+    };
+
+    static reader_type fd_reader(int fd) {
+        return [fd](T *dst, std::size_t n) -> std::size_t {
+            while (true) {
+                auto got = ::read(fd, dst, n * sizeof(T));
+                if (got >= 0) {
+                    return static_cast<std::size_t>(got) / sizeof(T);
+                }
+                if (errno != EINTR) {
+                    throw std::system_error(errno, std::generic_category(),
+                                            "StreamingInputStream read");
+                }
+            }
+        };
+    }
+
+    // Make sure at least n chars past m_pos are buffered. Returns
+    // false if the input ends first.
+    bool available(std::size_t n) { return buffered_to(m_pos + n); }
+
+    // The same up to the absolute position end.
+    bool buffered_to(std::size_t end) {
+        while (m_base + m_buf.size() < end) {
+            if (m_eof) {
+                return false;
+            }
+            refill();
+        }
+        return true;
+    }
+
+    void refill() {
+        release();
+
+        auto old = m_buf.size();
+        m_buf.resize(old + m_chunk_size);
+        auto got = m_reader(m_buf.data() + old, m_chunk_size);
+        m_buf.resize(old + got);
+        m_eof = (got == 0);
+    }
+
+    // Drop everything before the oldest position that can still be
+    // restored: the outermost live checkpoint, or the current position
+    // when there are no outstanding checkpoints. The farthest failure
+    // is kept too while failures are tracked.
+    void release() {
+        auto keep = low_water();
+        auto const &f = m_context.failures();
+        if (f.enabled() && !f.empty()) {
+            keep = std::min(keep, f.farthest());
+        }
+        if (keep <= m_base) {
+            return;
+        }
+        auto dead = keep - m_base;
+        for (std::size_t i = 0; i < dead; ++i) {
+            if (m_buf[i] == T('\n')) {
+                ++m_line;
+                m_column = 1;
+            } else {
+                ++m_column;
+            }
+        }
+        m_buf.erase(m_buf.begin(), m_buf.begin() + dead);
+        m_base = keep;
+
+        // Give back memory left over from a deep backtrack.
+        if (m_buf.capacity() > 4 * m_chunk_size &&
+            m_buf.size() < m_chunk_size) {
+            m_buf.shrink_to_fit();
+        }
+    }
+
+    reader_type    m_reader;
+    std::vector<T> m_buf;
+    std::size_t    m_base{0};   // absolute offset of m_buf[0]
+    std::size_t    m_pos{0};    // absolute offset
+    std::size_t    m_anchor{0}; // outermost live checkpoint
+    std::size_t    m_depth{0};  // number of live checkpoints
+    std::size_t    m_line{1};   // of m_buf[0], for parse_error
+    std::size_t    m_column{1};
+    std::size_t    m_chunk_size;
+    bool           m_eof{false};
+    Skip           m_skip;
+    ParseContext   m_context;
+};
+
+// Same contract as the InputStream overload. The stream has released
+// the text before the failure, but counted its lines as it went.
+template<typename T, typename Skip, typename Results>
+ParseError parse_error(StreamingInputStream<T, Skip, Results> &in) {
+    auto const &f = in.context().failures();
+    auto pos = in.skip_from(f.empty() ? in.get_pos() : f.farthest());
+    auto e   = parse_error(
+        std::basic_string_view<T>(in.m_buf.data(), pos - in.m_base), f);
+    if (e.line == 1) {
+        e.column += in.m_column - 1;
+    }
+    e.line += in.m_line - 1;
+    e.offset = pos;
+    return e;
+}
+
+CPPEG_NAMESPACE_CLOSE
+
+#endif
@@ -0,0 +1,458 @@
+#ifndef CPPEG_SYMBOLS_HPP
+#define CPPEG_SYMBOLS_HPP
+
+#include "cppeg_common.hpp"
+#include "rule.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+CPPEG_NAMESPACE_OPEN
+
+namespace detail {
+
+/**
+ * Radix (path-compressed) trie from strings of C to values of type V.
+ * No node owns an allocation: nodes live in one vector and refer to
+ * each other by index, edge labels are (offset, length) ranges of one
+ * shared string, and a node's edges are a range of two shared arrays,
+ * the first char of each child's label (sorted) and the child's index.
+ * Picking the next edge thus scans a few contiguous chars. Ranges
+ * left behind by growing or removing are reclaimed by compacting the
+ * arrays once they are mostly waste. Values are stored apart from the
+ * nodes to keep those small.
+ */
+template<typename V, typename C = char>
+class RadixTrie {
+public:
+    using key_type = std::basic_string_view<C>;
+
+    RadixTrie() : m_nodes(1) {}
+
+    // Returns false (and leaves the old value) if key is present.
+    bool add(key_type key, V value) {
+        auto slot = find_or_insert(key);
+        if (m_nodes[slot].value != no_value) {
+            return false;
+        }
+        auto v              = store(std::move(value));
+        m_nodes[slot].value = v;
+        m_max_length        = std::max(m_max_length, key.size());
+        ++m_size;
+        compact_if_wasteful();
+        return true;
+    }
+
+    bool remove(key_type key) {
+        std::vector<std::uint32_t> path;
+        auto                       n = find_node(key, &path);
+        if (n == no_node || m_nodes[n].value == no_value) {
+            return false;
+        }
+        m_free_values.push_back(m_nodes[n].value);
+        m_values[m_nodes[n].value].reset();
+        m_nodes[n].value = no_value;
+        --m_size;
+        prune(path);
+        compact_if_wasteful();
+        return true;
+    }
+
+    V const *find(key_type key) const {
+        auto n = find_node(key, nullptr);
+        if (n == no_node || m_nodes[n].value == no_value) {
+            return nullptr;
+        }
+        return &*m_values[m_nodes[n].value];
+    }
+
+    // Longest key that is a prefix of text: its value and length.
+    std::pair<V const *, std::size_t>
+    longest_prefix(key_type text) const {
+        std::pair<V const *, std::size_t> best{nullptr, 0};
+        if (m_nodes[0].value != no_value) {
+            best.first = &*m_values[m_nodes[0].value];
+        }
+        std::uint32_t n = 0;
+        std::size_t   i = 0;
+        while (i < text.size()) {
+            auto c = child(n, edge_key(text[i]));
+            if (c == no_node) {
+                break;
+            }
+            auto l = label(c);
+            if (text.compare(i, l.size(), l) != 0) {
+                break;
+            }
+            i += l.size();
+            n = c;
+            if (m_nodes[n].value != no_value) {
+                best = {&*m_values[m_nodes[n].value], i};
+            }
+        }
+        return best;
+    }
+
+    std::size_t size() const noexcept { return m_size; }
+
+    // Upper bound on the length of any key (not lowered by remove()).
+    std::size_t max_length() const noexcept { return m_max_length; }
+
+private:
+    static constexpr std::uint32_t no_node  = ~std::uint32_t{0};
+    static constexpr std::uint32_t no_value = ~std::uint32_t{0};
+
+    // The edge from the parent is m_labels[label_offset, +label_length);
+    // the edges to the children are [first_edge, first_edge +
+    // edge_count) of m_first/m_children, with room for edge_capacity.
+    struct Node {
+        std::uint32_t label_offset{0};
+        std::uint32_t label_length{0};
+        std::uint32_t first_edge{0};
+        std::uint32_t edge_count{0};
+        std::uint32_t edge_capacity{0};
+        std::uint32_t value{no_value};
+    };
+
+    // Edges are sorted by the first char of their label, as unsigned.
+    using edge_type = std::make_unsigned_t<C>;
+
+    static edge_type edge_key(C c) { return static_cast<edge_type>(c); }
+
+    // Only valid until the next change to m_labels.
+    key_type label(std::uint32_t n) const {
+        return key_type(m_labels.data() + m_nodes[n].label_offset,
+                        m_nodes[n].label_length);
+    }
+
+    std::uint32_t child(std::uint32_t n, edge_type c) const {
+        auto begin = m_first.begin() + m_nodes[n].first_edge;
+        auto end   = begin + m_nodes[n].edge_count;
+        auto it    = std::lower_bound(begin, end, c);
+        if (it == end || *it != c) {
+            return no_node;
+        }
+        return m_children[it - m_first.begin()];
+    }
+
+    void link(std::uint32_t parent, std::uint32_t c) {
+        auto key = edge_key(m_labels[m_nodes[c].label_offset]);
+        auto &n  = m_nodes[parent];
+        if (n.edge_count == n.edge_capacity) {
+            // Move the edges to a bigger range at the end.
+            auto capacity = std::max<std::uint32_t>(2, 2 * n.edge_capacity);
+            auto first    = static_cast<std::uint32_t>(m_first.size());
+            m_first.resize(first + capacity);
+            m_children.resize(first + capacity);
+            std::copy_n(m_first.begin() + n.first_edge, n.edge_count,
+                        m_first.begin() + first);
+            std::copy_n(m_children.begin() + n.first_edge, n.edge_count,
+                        m_children.begin() + first);
+            m_dead_edges += n.edge_capacity;
+            n.first_edge    = first;
+            n.edge_capacity = capacity;
+        }
+        auto begin = m_first.begin() + n.first_edge;
+        auto end   = begin + n.edge_count;
+        auto pos   = std::lower_bound(begin, end, key) - m_first.begin();
+        auto last  = n.first_edge + n.edge_count;
+        std::copy_backward(m_first.begin() + pos, m_first.begin() + last,
+                           m_first.begin() + last + 1);
+        std::copy_backward(m_children.begin() + pos,
+                           m_children.begin() + last,
+                           m_children.begin() + last + 1);
+        m_first[pos]    = key;
+        m_children[pos] = c;
+        ++n.edge_count;
+    }
+
+    void unlink(std::uint32_t parent, std::uint32_t c) {
+        auto &n     = m_nodes[parent];
+        auto  begin = m_children.begin() + n.first_edge;
+        auto  last  = n.first_edge + n.edge_count;
+        auto  pos   = std::find(begin, begin + n.edge_count, c) -
+                   m_children.begin();
+        std::copy(m_first.begin() + pos + 1, m_first.begin() + last,
+                  m_first.begin() + pos);
+        std::copy(m_children.begin() + pos + 1, m_children.begin() + last,
+                  m_children.begin() + pos);
+        --n.edge_count;
+    }
+
+    // Appends text to m_labels, returning its offset.
+    std::uint32_t add_label(key_type text) {
+        auto offset = static_cast<std::uint32_t>(m_labels.size());
+        m_labels.append(text.data(), text.size());
+        return offset;
+    }
+
+    std::uint32_t new_node(std::uint32_t label_offset,
+                           std::uint32_t label_length) {
+        std::uint32_t n;
+        if (!m_free_nodes.empty()) {
+            n = m_free_nodes.back();
+            m_free_nodes.pop_back();
+        } else {
+            n = static_cast<std::uint32_t>(m_nodes.size());
+            m_nodes.emplace_back();
+        }
+        m_nodes[n]              = Node{};
+        m_nodes[n].label_offset = label_offset;
+        m_nodes[n].label_length = label_length;
+        return n;
+    }
+
+    void free_node(std::uint32_t n) {
+        m_dead_edges += m_nodes[n].edge_capacity;
+        m_nodes[n] = Node{};
+        m_free_nodes.push_back(n);
+    }
+
+    std::uint32_t store(V value) {
+        if (!m_free_values.empty()) {
+            auto v = m_free_values.back();
+            m_free_values.pop_back();
+            m_values[v] = std::move(value);
+            return v;
+        }
+        m_values.emplace_back(std::move(value));
+        return static_cast<std::uint32_t>(m_values.size() - 1);
+    }
+
+    // The node reached by key, recording the nodes passed (root first,
+    // the node itself last) in path if given.
+    std::uint32_t find_node(key_type key,
+                            std::vector<std::uint32_t> *path) const {
+        std::uint32_t n = 0;
+        if (path) {
+            path->push_back(n);
+        }
+        while (!key.empty()) {
+            auto c = child(n, edge_key(key[0]));
+            if (c == no_node) {
+                return no_node;
+            }
+            auto l = label(c);
+            if (key.substr(0, l.size()) != l) {
+                return no_node;
+            }
+            key.remove_prefix(l.size());
+            n = c;
+            if (path) {
+                path->push_back(n);
+            }
+        }
+        return n;
+    }
+
+    // The node for key, creating (and splitting) nodes as needed.
+    std::uint32_t find_or_insert(key_type key) {
+        std::uint32_t n = 0;
+        while (!key.empty()) {
+            auto c = child(n, edge_key(key[0]));
+            if (c == no_node) {
+                auto leaf = new_node(add_label(key),
+                                     static_cast<std::uint32_t>(key.size()));
+                link(n, leaf);
+                return leaf;
+            }
+            auto          l = label(c);
+            std::uint32_t p = 0;
+            while (p < l.size() && p < key.size() && l[p] == key[p]) {
+                ++p;
+            }
+            if (p < l.size()) {
+                // Split the edge: n -> mid (label[0, p)) -> c (the
+                // rest). Both halves keep using c's label text.
+                auto mid = new_node(m_nodes[c].label_offset, p);
+                unlink(n, c);
+                m_nodes[c].label_offset += p;
+                m_nodes[c].label_length -= p;
+                link(mid, c);
+                link(n, mid);
+                c = mid;
+            }
+            key.remove_prefix(p);
+            n = c;
+        }
+        return n;
+    }
+
+    // After a removal from the last node of path (root first): drop
+    // nodes left without value or children, and merge a valueless node
+    // into its only child.
+    void prune(std::vector<std::uint32_t> &path) {
+        while (path.size() > 1) {
+            auto n      = path.back();
+            auto parent = path[path.size() - 2];
+            if (m_nodes[n].value != no_value || m_nodes[n].edge_count > 1) {
+                break;
+            }
+            unlink(parent, n);
+            if (m_nodes[n].edge_count == 1) {
+                auto  only  = m_children[m_nodes[n].first_edge];
+                auto &above = m_nodes[n];
+                auto &below = m_nodes[only];
+                if (above.label_offset + above.label_length ==
+                    below.label_offset) {
+                    // Still adjacent, as after a split.
+                    below.label_offset = above.label_offset;
+                } else {
+                    std::basic_string<C> merged(label(n));
+                    merged += label(only);
+                    m_dead_labels += merged.size();
+                    below.label_offset = add_label(merged);
+                }
+                below.label_length += above.label_length;
+                link(parent, only);
+            } else {
+                m_dead_labels += m_nodes[n].label_length;
+            }
+            free_node(n);
+            path.pop_back();
+        }
+    }
+
+    void compact_if_wasteful() {
+        if (2 * m_dead_labels > m_labels.size() ||
+            2 * m_dead_edges > m_first.size()) {
+            compact();
+        }
+    }
+
+    // Copy the live labels and edges, depth first, into new arrays
+    // without gaps.
+    void compact() {
+        std::basic_string<C>       labels;
+        std::vector<edge_type>     first;
+        std::vector<std::uint32_t> children;
+        labels.reserve(m_labels.size() - m_dead_labels);
+        first.reserve(m_first.size() - m_dead_edges);
+        children.reserve(m_first.size() - m_dead_edges);
+
+        std::vector<std::uint32_t> todo{0};
+        while (!todo.empty()) {
+            auto &n = m_nodes[todo.back()];
+            todo.pop_back();
+
+            auto offset = static_cast<std::uint32_t>(labels.size());
+            labels.append(m_labels, n.label_offset, n.label_length);
+            n.label_offset = offset;
+
+            auto edges = static_cast<std::uint32_t>(first.size());
+            auto begin = n.first_edge;
+            auto end   = begin + n.edge_count;
+            first.insert(first.end(), m_first.begin() + begin,
+                         m_first.begin() + end);
+            children.insert(children.end(), m_children.begin() + begin,
+                            m_children.begin() + end);
+            n.first_edge    = edges;
+            n.edge_capacity = n.edge_count;
+            todo.insert(todo.end(), m_children.begin() + begin,
+                        m_children.begin() + end);
+        }
+
+        m_labels      = std::move(labels);
+        m_first       = std::move(first);
+        m_children    = std::move(children);
+        m_dead_labels = 0;
+        m_dead_edges  = 0;
+    }
+
+    std::vector<Node>             m_nodes; // m_nodes[0]: root
+    std::basic_string<C>          m_labels;
+    std::vector<edge_type>        m_first;
+    std::vector<std::uint32_t>    m_children;
+    std::vector<std::optional<V>> m_values;
+    std::vector<std::uint32_t>    m_free_nodes;
+    std::vector<std::uint32_t>    m_free_values;
+    std::size_t                   m_dead_labels{0}; // chars of m_labels
+    std::size_t                   m_dead_edges{0};  // slots of m_first
+    std::size_t                   m_size{0};
+    std::size_t                   m_max_length{0};
+};
+
+} // end namespace detail
+
+/**
+ * Matches the longest key of a runtime-modifiable table and returns
+ * its value, like Spirit's qi::symbols:
+ *
+ *   Symbols<int> types;
+ *   types.add("int", 4);
+ *   auto decl = types + identifier;   // parses with the current table
+ *   types.add("point", 16);           // seen by decl from now on
+ *
+ * Copies share one table, so symbols added after the grammar was built
+ * (declared types, say) are recognised by it. Lookup walks a radix
+ * trie in O(key length). Parsing only reads the table, so any number
+ * of threads may parse with it concurrently, provided none of them
+ * calls add() or remove() meanwhile.
+ *
+ * C is the char type of the keys, which must be the stream's:
+ * Symbols<int, wchar_t> for an InputStream<wchar_t>.
+ */
+template<typename V, typename C = char>
+class Symbols : public Rule<Symbols<V, C>> {
+public:
+    using key_type = std::basic_string_view<C>;
+
+    Symbols() : m_table(std::make_shared<detail::RadixTrie<V, C>>()) {}
+    Symbols(std::initializer_list<std::pair<key_type, V>> symbols)
+        : Symbols() {
+        for (auto const &[key, value] : symbols) {
+            add(key, value);
+        }
+    }
+
+    static constexpr bool reports_failure = true;
+
+    // The keys change at run time, so a ParseError names the table's
+    // kind of token rather than listing them.
+    static constexpr std::string_view expected_name() { return "symbol"; }
+
+    // Returns false, keeping the old value, if key is already present.
+    bool add(key_type key, V value) {
+        return m_table->add(key, std::move(value));
+    }
+
+    bool remove(key_type key) { return m_table->remove(key); }
+
+    // The value for exactly key, or nullptr.
+    V const *find(key_type key) const { return m_table->find(key); }
+
+    std::size_t size() const noexcept { return m_table->size(); }
+
+    template<typename Stream>
+    std::optional<V> parse_impl(Stream &in) {
+        static_assert(
+            std::is_same_v<decltype(in.lookahead(0)), key_type>,
+            "Symbols: the keys' char type (Symbols<V, C>) must be the "
+            "stream's");
+
+        in.peekChar(); // skip leading whitespace, if any
+        auto [value, length] =
+            m_table->longest_prefix(in.lookahead(m_table->max_length()));
+        if (!value) {
+            return std::nullopt;
+        }
+        in.advance_n_unchecked(static_cast<int>(length));
+        return *value;
+    }
+
+private:
+    std::shared_ptr<detail::RadixTrie<V, C>> m_table;
+};
+
+CPPEG_NAMESPACE_CLOSE
+
+#endif
@@ -0,0 +1,315 @@
+#ifndef CPPEG_TOKEN_STREAM_HPP
+#define CPPEG_TOKEN_STREAM_HPP
+
+#include "char_table.hpp"
+#include "cppeg_common.hpp"
+#include "input_stream.hpp"
+#include "parse_context.hpp"
+#include "rule.hpp"
+#include "whitespace.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+CPPEG_NAMESPACE_OPEN
+
+// One lexed token: its kind (see Lexer) and where it is in the text.
+struct Token {
+    std::uint32_t kind;
+    std::uint32_t offset;
+    std::uint32_t length;
+
+    // Kind of the token TokenStream::peekChar() returns at the end.
+    static constexpr std::uint32_t end_kind =
+        std::numeric_limits<std::uint32_t>::max();
+};
+
+/**
+ * Stream over a token array produced by a Lexer, with the interface
+ * the combinators expect of InputStream (checkpoints, next_if, span,
+ * context, ...), so AndRule, OrRule, repetition, memoization and
+ * RuleRef run over tokens unchanged. Positions are token indices, and
+ * the token-kind rule Tok<K> replaces the char rules: backtracking
+ * over an identifier then costs one integer compare instead of
+ * re-scanning its chars and the whitespace around it.
+ *
+ * Neither the text nor the tokens are copied; both must outlive the
+ * stream.
+ */
+class TokenStream {
+public:
+    TokenStream(std::string_view text, std::vector<Token> const &tokens)
+        : m_text(text), m_tokens(tokens.data()), m_count(tokens.size()) {}
+
+    // The stream keeps a pointer into the tokens; a temporary vector
+    // would be gone before the first parse.
+    TokenStream(std::string_view, std::vector<Token> &&) = delete;
+
+    using checkpoint_type = std::size_t;
+
+    // Same contract as InputStream.
+    checkpoint_type checkpoint() const noexcept { return m_pos; }
+
+    void commit(checkpoint_type) noexcept {}
+
+    void restore(checkpoint_type cp) noexcept { m_pos = cp; }
+
+    void enter_checkpoint(checkpoint_type cp) noexcept {
+        if (m_depth++ == 0) {
+            m_anchor = cp;
+        }
+    }
+
+    void leave_checkpoint() noexcept {
+        debug_assert(m_depth > 0, "leave_checkpoint without a matching enter");
+        --m_depth;
+    }
+
+    std::size_t low_water() const noexcept {
+        return m_depth ? m_anchor : m_pos;
+    }
+
+    // Consume the next token if pred accepts it.
+    template<typename Pred>
+    std::optional<Token> next_if(Pred &&pred) {
+        if (m_pos < m_count && pred(m_tokens[m_pos])) {
+            return m_tokens[m_pos++];
+        }
+        return std::nullopt;
+    }
+
+    // The next token without consuming it; kind Token::end_kind at the
+    // end. (Named after InputStream::peekChar, which rules such as
+    // span() call.)
+    Token peekChar() const noexcept {
+        if (m_pos < m_count) {
+            return m_tokens[m_pos];
+        }
+        return Token{Token::end_kind, static_cast<std::uint32_t>(m_text.size()),
+                     0};
+    }
+
+    void advance_n_unchecked(int n) { m_pos += n; }
+
+    auto get_pos() const noexcept { return m_pos; }
+    auto distance_to_end() const noexcept { return m_count - m_pos; }
+    bool at_end() const noexcept { return m_pos == m_count; }
+
+    // The whole text the tokens were lexed from.
+    std::string_view source() const noexcept { return m_text; }
+
+    // Offset in the text of the token at pos (as from get_pos()), or
+    // the text's size at the end.
+    std::size_t offset_of(std::size_t pos) const {
+        return pos < m_count ? m_tokens[pos].offset : m_text.size();
+    }
+
+    // The text of a token.
+    std::string_view text(Token const &t) const {
+        return m_text.substr(t.offset, t.length);
+    }
+
+    // The text from the start of token `from` to the end of token
+    // `to - 1` (as from get_pos()), including anything skipped between.
+    std::string_view span(std::size_t from, std::size_t to) const {
+        if (from >= to) {
+            return m_text.substr(offset_of(from), 0);
+        }
+        auto begin = m_tokens[from].offset;
+        auto end   = m_tokens[to - 1].offset + m_tokens[to - 1].length;
+        return m_text.substr(begin, end - begin);
+    }
+
+    ParseContext &context() noexcept { return m_context; }
+
+private:
+    std::string_view m_text;
+    Token const *    m_tokens;
+    std::size_t      m_count;
+    std::size_t      m_pos{0};
+    std::size_t      m_anchor{0};
+    std::size_t      m_depth{0};
+    ParseContext     m_context;
+};
+
+/**
+ * Matches one token of kind K (an integer or enumerator) on a
+ * TokenStream, returning its text.
+ */
+template<auto K>
+struct TokenRule : public Rule<TokenRule<K>> {
+    static constexpr bool restores_on_failure = true;
+    static constexpr bool reports_failure     = true;
+
+    static constexpr std::uint32_t kind = static_cast<std::uint32_t>(K);
+
+    template<typename Stream>
+    auto parse_impl(Stream &in) {
+        std::optional<std::string_view> ret;
+        if (auto t = in.next_if([](Token const &t) { return t.kind == kind; })) {
+            ret = in.text(*t);
+        }
+        return ret;
+    }
+};
+
+template<auto K>
+constexpr TokenRule<K> Tok = TokenRule<K>{};
+
+// parse_error() for a token-level parse, located at the start of the
+// token the farthest failure happened at.
+inline ParseError parse_error(TokenStream &in) {
+    auto const &f   = in.context().failures();
+    auto        pos = f.empty() ? in.get_pos() : f.farthest();
+    return parse_error(in.source().substr(0, in.offset_of(pos)), f);
+}
+
+//======================================================================
+
+namespace detail {
+
+template<auto K, typename R>
+struct TokenDef {
+    R rule;
+};
+
+} // end namespace detail
+
+// A token kind and the char-level rule recognising it, for lexer().
+template<auto K, typename R>
+auto token(Rule<R> const &r) {
+    return detail::TokenDef<K, R>{r.self()};
+}
+
+/**
+ * Splits text into Tokens once, ahead of parsing. Each token kind is
+ * defined by an ordinary char-level rule (token<Kind>(rule)); at every
+ * position the longest match wins, the first definition on ties (so a
+ * keyword listed before the identifier rule takes "if" but not "iff").
+ * Definitions whose first set (see FirstSet) excludes the next char
+ * are not tried. Text matched by the skip rule, if any, separates
+ * tokens and is dropped.
+ */
+template<typename Skip, typename... Defs>
+class Lexer {
+public:
+    Lexer(Skip skip, Defs... defs)
+        : m_skip(std::move(skip)), m_defs(std::move(defs)...) {}
+
+    // Token offsets are 32 bits, so longer text cannot be tokenized.
+    static constexpr std::size_t max_text_size =
+        std::numeric_limits<std::uint32_t>::max();
+
+    // Throws std::length_error if text of this size cannot be
+    // tokenized.
+    static void check_text_size(std::size_t size) {
+        if (size > max_text_size) {
+            throw std::length_error("Lexer::tokenize: text longer than "
+                                    "max_text_size");
+        }
+    }
+
+    // Appends the tokens of text to out. Returns where lexing stopped:
+    // text.size() on success, otherwise the first char that starts no
+    // token. Throws std::length_error if text is longer than
+    // max_text_size.
+    std::size_t tokenize(std::string_view text,
+                         std::vector<Token> &out) const {
+        check_text_size(text.size());
+        InputStream<char, NoSkip> in(text);
+        while (true) {
+            skip(in);
+            auto pos = in.get_pos();
+            if (pos == text.size()) {
+                return pos;
+            }
+
+            auto c          = static_cast<unsigned char>(text[pos]);
+            auto best_kind  = Token::end_kind;
+            auto best_len   = std::size_t{0};
+            auto try_define = [&](auto &def) {
+                using def_type = std::decay_t<decltype(def)>;
+                constexpr auto first =
+                    first_set_of_def(static_cast<def_type *>(nullptr));
+                if (!first.nullable && !first.chars.test(c)) {
+                    return;
+                }
+                auto cp = in.checkpoint();
+                if (parse_success(def.rule.parse(in)) &&
+                    in.get_pos() - pos > best_len) {
+                    best_len  = in.get_pos() - pos;
+                    best_kind = kind_of_def(static_cast<def_type *>(nullptr));
+                }
+                in.restore(cp);
+            };
+            std::apply([&](auto &... defs) { (try_define(defs), ...); },
+                       m_defs);
+
+            if (best_len == 0) {
+                return pos;
+            }
+            out.push_back(Token{best_kind, static_cast<std::uint32_t>(pos),
+                                static_cast<std::uint32_t>(best_len)});
+            in.advance_n_unchecked(static_cast<int>(best_len));
+        }
+    }
+
+    std::vector<Token> tokenize(std::string_view text) const {
+        std::vector<Token> out;
+        tokenize(text, out);
+        return out;
+    }
+
+private:
+    template<auto K, typename R>
+    static constexpr detail::FirstSet first_set_of_def(detail::TokenDef<K, R> *) {
+        return detail::first_set_of<R>;
+    }
+    template<auto K, typename R>
+    static constexpr std::uint32_t kind_of_def(detail::TokenDef<K, R> *) {
+        return static_cast<std::uint32_t>(K);
+    }
+
+    void skip(InputStream<char, NoSkip> &in) const {
+        if constexpr (!std::is_same_v<Skip, NoSkip>) {
+            while (true) {
+                auto before = in.get_pos();
+                if (!parse_success(m_skip.parse(in)) ||
+                    in.get_pos() == before) {
+                    return;
+                }
+            }
+        }
+    }
+
+    // Rule::parse is non-const, while lexing is logically const.
+    mutable Skip                m_skip;
+    mutable std::tuple<Defs...> m_defs;
+};
+
+// Lexer with tokens separated by text matching skip (whitespace,
+// comments).
+template<typename Skip, auto... Ks, typename... Rs>
+auto lexer(Rule<Skip> const &skip, detail::TokenDef<Ks, Rs>... defs) {
+    return Lexer<Skip, detail::TokenDef<Ks, Rs>...>(skip.self(),
+                                                    std::move(defs)...);
+}
+
+// Lexer where tokens must be adjacent.
+template<auto... Ks, typename... Rs>
+auto lexer(detail::TokenDef<Ks, Rs>... defs) {
+    return Lexer<NoSkip, detail::TokenDef<Ks, Rs>...>(NoSkip{},
+                                                      std::move(defs)...);
+}
+
+CPPEG_NAMESPACE_CLOSE
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef CPPEG_TYPE_NAME_HPP
+#define CPPEG_TYPE_NAME_HPP
+
+#include "cppeg_common.hpp"
+#include <string_view>
+
+CPPEG_NAMESPACE_OPEN
+
+namespace helpers {
+
+// The type in the __PRETTY_FUNCTION__ text p of type_name<T>(): from
+// the end of key to the last tail, which is searched from the back so
+// that a ';' or ']' inside the type (CharRule<';'>) does not cut it
+// short. The whole of p if either is missing, so a compiler with
+// another format gets a longer name, not an error during constant
+// evaluation.
+constexpr std::string_view pretty_type(std::string_view p,
+                                       std::string_view key,
+                                       std::string_view tail) {
+    auto start = p.find(key);
+    if (start == std::string_view::npos) {
+        return p;
+    }
+    start += key.size();
+    auto stop = p.rfind(tail);
+    if (stop == std::string_view::npos || stop < start) {
+        return p;
+    }
+    return p.substr(start, stop - start);
+}
+
+template <class T>
+constexpr
+std::string_view
+type_name()
+{
+    using namespace std;
+#ifdef __clang__
+    return pretty_type(__PRETTY_FUNCTION__, "[T = ", "]");
+#elif defined(__GNUC__)
+    string_view p = __PRETTY_FUNCTION__;
+#  if __cplusplus < 201402
+    return string_view(p.data() + 36, p.size() - 36 - 1);
+#  else
+    return pretty_type(p, "with T = ", "; std::string_view = ");
+#  endif
+#elif defined(_MSC_VER)
+    string_view p = __FUNCSIG__;
+    return string_view(p.data() + 84, p.size() - 84 - 7);
+#endif
+
+    
+}
+
+} // end namespace helpers
+
+CPPEG_NAMESPACE_CLOSE
+
+#endif
@@ -0,0 +1,154 @@
+#ifndef CPPEG_WHITESPACE_HPP
+#define CPPEG_WHITESPACE_HPP
+
+#include "cppeg_common.hpp"
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+CPPEG_NAMESPACE_OPEN
+
+namespace detail {
+
+// The chars std::isspace accepts in the "C" locale:
+// ' ', '\t', '\n', '\v', '\f', '\r'.
+constexpr bool is_ascii_space(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+constexpr std::array<bool, 256> make_ascii_space_table() {
+    std::array<bool, 256> table{};
+    for (int c = 0; c < 256; ++c) {
+        table[c] = is_ascii_space(static_cast<unsigned char>(c));
+    }
+    return table;
+}
+
+inline constexpr std::array<bool, 256> ascii_space_table =
+    make_ascii_space_table();
+
+/**
+ * Returns a pointer to the first non-whitespace char in [p, end),
+ * or end. Most calls see no whitespace or a single separator, so the
+ * first char is checked before switching to the vector loops, which
+ * pay off on long runs (indentation, blank lines).
+ */
+inline char const *skip_ascii_whitespace(char const *p, char const *end) {
+    if (p == end || !ascii_space_table[static_cast<unsigned char>(*p)]) {
+        return p;
+    }
+    ++p;
+
+#if defined(__AVX2__)
+    {
+        const __m256i space = _mm256_set1_epi8(' ');
+        const __m256i lo    = _mm256_set1_epi8('\t' - 1);
+        const __m256i hi    = _mm256_set1_epi8('\r' + 1);
+        while (end - p >= 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p));
+            // signed compares: bytes >= 0x80 are negative, never in range
+            __m256i ws = _mm256_or_si256(
+                _mm256_cmpeq_epi8(v, space),
+                _mm256_and_si256(_mm256_cmpgt_epi8(v, lo),
+                                 _mm256_cmpgt_epi8(hi, v)));
+            unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(ws));
+            if (mask) {
+                return p + __builtin_ctz(mask);
+            }
+            p += 32;
+        }
+    }
+#endif
+
+#if defined(__SSE2__)
+    {
+        const __m128i space = _mm_set1_epi8(' ');
+        const __m128i lo    = _mm_set1_epi8('\t' - 1);
+        const __m128i hi    = _mm_set1_epi8('\r' + 1);
+        while (end - p >= 16) {
+            __m128i v  = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+            __m128i ws = _mm_or_si128(_mm_cmpeq_epi8(v, space),
+                                      _mm_and_si128(_mm_cmpgt_epi8(v, lo),
+                                                    _mm_cmplt_epi8(v, hi)));
+            unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(ws)) &
+                            0xFFFFu;
+            if (mask) {
+                return p + __builtin_ctz(mask);
+            }
+            p += 16;
+        }
+    }
+#endif
+
+    while (p != end && ascii_space_table[static_cast<unsigned char>(*p)]) {
+        ++p;
+    }
+    return p;
+}
+
+// Index of the first non-whitespace char of text at or after pos.
+template<typename T>
+std::size_t skip_ascii_whitespace(std::basic_string_view<T> text,
+                                  std::size_t                pos) {
+    if constexpr (sizeof(T) == 1) {
+        auto begin = reinterpret_cast<char const *>(text.data());
+        return skip_ascii_whitespace(begin + pos, begin + text.size()) -
+               begin;
+    } else {
+        const auto N = text.size();
+        while (pos < N && text[pos] >= 0 && text[pos] < 256 &&
+               ascii_space_table[text[pos]]) {
+            ++pos;
+        }
+        return pos;
+    }
+}
+
+} // end namespace detail
+
+//--------------------------------------------------------------------------
+// Skip policies for InputStream. A policy provides
+//
+//     std::size_t skip(std::basic_string_view<T> text, std::size_t pos) const
+//
+// returning the position of the first char at or after pos that a rule
+// should see. See skip_rule.hpp for a policy driven by a grammar rule.
+
+// Never skip anything: reading a char is a bounds check and an increment.
+struct NoSkip {
+    template<typename T>
+    constexpr std::size_t skip(std::basic_string_view<T>,
+                               std::size_t pos) const noexcept {
+        return pos;
+    }
+};
+
+// Always skip ASCII whitespace.
+struct SkipWhitespace {
+    template<typename T>
+    std::size_t skip(std::basic_string_view<T> text, std::size_t pos) const {
+        return detail::skip_ascii_whitespace(text, pos);
+    }
+};
+
+// Skip ASCII whitespace depending on a flag that can change during the
+// parse (InputStream::get_ignore_state/set_ignore_state).
+struct RuntimeWhitespace {
+    constexpr RuntimeWhitespace(bool ignore = false) : ignore(ignore) {}
+
+    template<typename T>
+    std::size_t skip(std::basic_string_view<T> text, std::size_t pos) const {
+        return ignore ? detail::skip_ascii_whitespace(text, pos) : pos;
+    }
+
+    bool ignore;
+};
+
+CPPEG_NAMESPACE_CLOSE
+
+#endif
@@ -0,0 +1,158 @@
+#include "catch.hpp"
+#include "cppeg.hpp"
+
+#include <algorithm>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+using namespace cppeg;
+
+namespace {
+
+using ArenaStream = InputStream<char, NoSkip, ArenaResults>;
+
+} // namespace
+
+TEST_CASE("Arena: heap results by default") {
+    std::string   s = "aab";
+    InputStream<> S(s);
+
+    auto ret = (*Char<'a'>).parse(S);
+    CHECK((std::is_same_v<decltype(ret), std::optional<std::vector<char>>>));
+
+    auto lit = Literal("b").parse(S);
+    CHECK((std::is_same_v<decltype(lit), std::optional<std::string>>));
+}
+
+TEST_CASE("Arena: repetitions and literals use the stream's arena") {
+    std::string s = "ab,ab,abc";
+    ArenaStream S(s);
+    auto        resource = S.context().arena().resource();
+
+    auto item = Literal("ab") + ~repeat<0, 1>(~Char<','>);
+    auto list = *item + Literal("c");
+    auto ret  = list.parse(S);
+    REQUIRE(ret.has_value());
+
+    auto &[items, c] = *ret;
+    CHECK((std::is_same_v<std::decay_t<decltype(items)>,
+                          std::pmr::vector<std::tuple<std::pmr::string>>>));
+    CHECK(items.size() == 3);
+    CHECK(items.get_allocator().resource() == resource);
+    CHECK(std::get<0>(items[0]) == "ab");
+    CHECK(std::get<0>(items[2]).get_allocator().resource() == resource);
+    CHECK(c == "c");
+    CHECK(c.get_allocator().resource() == resource);
+}
+
+TEST_CASE("Arena: nested repetitions share it") {
+    std::string s = "aa;a;aaa;";
+    ArenaStream S(s);
+
+    auto rows = *(+Char<'a'> + ~Char<';'>);
+    auto ret  = rows.parse(S);
+    REQUIRE(ret.has_value());
+    REQUIRE(ret->size() == 3);
+
+    auto resource = S.context().arena().resource();
+    for (auto &row : *ret) {
+        CHECK(std::get<0>(row).get_allocator().resource() == resource);
+    }
+    CHECK(std::get<0>((*ret)[2]).size() == 3);
+}
+
+TEST_CASE("Arena: released after a parse") {
+    std::string s(1000, 'x');
+    ArenaStream S(s);
+
+    {
+        auto xs = (*Char<'x'>).parse(S);
+        REQUIRE(xs.has_value());
+        CHECK(xs->size() == 1000);
+    }
+    S.context().arena().release();
+
+    // Still usable afterwards.
+    ArenaStream T(s);
+    auto        again = (*Char<'x'>).parse(T);
+    REQUIRE(again.has_value());
+    CHECK(again->size() == 1000);
+}
+
+TEST_CASE("Arena: one arena reused across streams") {
+    Arena       arena(64);
+    std::string s(100, 'x');
+
+    for (int i = 0; i < 3; ++i) {
+        arena.release();
+        ArenaStream S(s);
+        S.context().set_arena(arena);
+
+        auto xs = (*Char<'x'>).parse(S);
+        REQUIRE(xs.has_value());
+        CHECK(xs->size() == 100);
+        CHECK(xs->get_allocator().resource() == arena.resource());
+    }
+
+    // After release() the blocks are reused, not reallocated.
+    auto capacity = arena.capacity();
+    CHECK(capacity >= 100);
+    arena.release();
+    void *a = arena.resource()->allocate(8, 8);
+    arena.release();
+    void *b = arena.resource()->allocate(8, 8);
+    CHECK(a == b);
+    CHECK(arena.capacity() == capacity);
+
+    arena.clear();
+    CHECK(arena.capacity() == 0);
+}
+
+TEST_CASE("Arena: memoized results are replayed onto it") {
+    std::string s = "aa;aab";
+    ArenaStream S(s);
+    auto        resource = S.context().arena().resource();
+
+    // Both alternatives start with the same memoized rule, so the
+    // second one replays it.
+    for (auto use_packrat : {true, false}) {
+        auto as  = *Char<'a'> + Literal(";");
+        auto row = [&](auto head) {
+            return (head + Char<'x'>) | (head + *Char<'a'> + Literal("b"));
+        };
+        S.restore(0);
+        auto ret = use_packrat ? row(packrat(as)).parse(S)
+                               : row(memo(as)).parse(S);
+        REQUIRE(ret.index() == 2);
+
+        auto &[head, rest, b] = std::get<2>(ret);
+        auto &[xs, semi]      = head;
+        CHECK(xs.size() == 2);
+        CHECK(xs.get_allocator().resource() == resource);
+        CHECK(semi.get_allocator().resource() == resource);
+        CHECK(rest.get_allocator().resource() == resource);
+        CHECK(b == "b");
+    }
+}
+
+TEST_CASE("Arena: streaming spans use it") {
+    std::string text = "aab";
+    StreamingInputStream<char, NoSkip, ArenaResults> S(
+        [&, off = std::size_t{0}](char *dst, std::size_t n) mutable {
+            auto len = std::min(n, text.size() - off);
+            std::copy_n(text.data() + off, len, dst);
+            off += len;
+            return len;
+        },
+        NoSkip{}, 1);
+
+    auto ret = (span(+Char<'a'>) + Char<'b'>).parse(S);
+    REQUIRE(ret.has_value());
+    auto &aa = std::get<0>(*ret);
+    CHECK((std::is_same_v<std::decay_t<decltype(aa)>, std::pmr::string>));
+    CHECK(aa == "aa");
+    CHECK(aa.get_allocator().resource() == S.context().arena().resource());
+}
@@ -0,0 +1,143 @@
+#include "catch.hpp"
+#include "cppeg.hpp"
+
+#include <type_traits>
+
+using namespace cppeg;
+
+TEST_CASE("CharClass: ranges and single chars") {
+
+    using ident = CharClass<CharRng<'A', 'Z'>, CharRng<'a', 'z'>,
+                            CharRng<'0', '9'>, CharRule<'_'>>;
+
+    std::string   s = "aZ_9-";
+    InputStream<> S(s);
+    ident         r;
+
+    for (char expected : {'a', 'Z', '_', '9'}) {
+        auto ret = r.parse(S);
+        REQUIRE(ret.has_value());
+        CHECK(*ret == expected);
+    }
+    CHECK(r.parse(S).has_value() == false);
+    CHECK(S.get_pos() == 4);
+}
+
+TEST_CASE("CharClass: negation") {
+
+    auto not_quote = negate(AnyChar<'"', '\\'>{});
+    CHECK((std::is_same_v<decltype(not_quote),
+                          NotCharClass<AnyChar<'"', '\\'>>>));
+
+    std::string   s = "a\\\xff";
+    InputStream<> S(s);
+
+    CHECK(not_quote.parse(S).has_value());
+    CHECK(not_quote.parse(S).has_value() == false);
+
+    auto quote = negate(not_quote);
+    CHECK(quote.parse(S).has_value());
+    S.restore(2);
+    CHECK(not_quote.parse(S).value() == '\xff');
+}
+
+TEST_CASE("CharClass: operator| folds at compile time") {
+
+    auto alnum = CharRng<'a', 'z'>{} | CharRng<'0', '9'>{} | Char<'_'>;
+    using expected =
+        CharClass<CharRng<'a', 'z'>, CharRng<'0', '9'>, CharRule<'_'>>;
+    CHECK((std::is_same_v<decltype(alnum), expected>));
+    CHECK(std::is_empty_v<decltype(alnum)>);
+
+    auto table = decltype(alnum)::char_table();
+    CHECK(table.test('q'));
+    CHECK(table.test('5'));
+    CHECK(table.test('_'));
+    CHECK(table.test('-') == false);
+
+    std::string   s = "x_1";
+    InputStream<> S(s);
+    auto ret = (alnum + alnum + alnum).parse(S);
+    CHECK(ret.has_value());
+
+    // Single chars keep the OrRule behaviour (variant result).
+    auto ab = Char<'a'> | Char<'b'>;
+    CHECK((std::is_same_v<decltype(ab), OrRule<CharRule<'a'>, CharRule<'b'>>>));
+}
+
+TEST_CASE("CharClass: range tables agree with CharRng across 0x80") {
+
+    // With a signed char this range wraps: 0x90..0xff, then 0x00..0x10.
+    // Either way, the table must hold exactly what parse() accepts.
+    auto check = [](auto rng) {
+        auto table = decltype(rng)::char_table();
+        bool agree = true;
+        for (unsigned v = 0; v < 256; ++v) {
+            std::string   s(1, static_cast<char>(v));
+            InputStream<> S(s);
+            agree &= rng.parse(S).has_value() ==
+                     table.test(static_cast<unsigned char>(v));
+        }
+        return agree;
+    };
+    CHECK(check(CharRng<'\x90', '\x10'>{}));
+    CHECK(check(CharRng<'\x80', '\xff'>{}));
+    CHECK(check(CharRng<'a', 'z'>{}));
+
+    // OrRule dispatch relies on the table.
+    auto rule = CharRng<'\x90', '\x10'>{} | "zz"_lit;
+    std::string   s = "\x05";
+    InputStream<> S(s);
+    CHECK(rule.parse(S).index() == 1);
+}
+
+TEST_CASE("CharClass: wide chars past the table") {
+
+    auto not_quote = negate(AnyChar<'"'>{});
+    auto lower     = CharClass<CharRng<'a', 'z'>>{};
+    auto nested    = CharClass<CharRule<'_'>, decltype(not_quote)>{};
+
+    std::wstring         s = L"aé中";
+    InputStream<wchar_t> S(s);
+
+    CHECK(lower.parse(S).value() == L'a');
+    CHECK(lower.parse(S).has_value() == false);
+    CHECK(not_quote.parse(S).value() == L'é');
+    CHECK(lower.parse(S).has_value() == false);
+    CHECK(negate(not_quote).parse(S).has_value() == false);
+    CHECK(nested.parse(S).value() == L'中');
+    CHECK((std::is_same_v<decltype(nested.parse(S)), std::optional<wchar_t>>));
+}
+
+TEST_CASE("CharClass: wide chars agree with the items' own rules") {
+
+    // With a signed char, CharRng<'\x80', '\xff'> holds no wide char
+    // 128-255; either way, wrapping it in a class must not change that.
+    auto check = [](auto item) {
+        auto cls   = CharClass<decltype(item)>{};
+        auto neg   = negate(cls);
+        bool agree = true;
+        for (int v = -300; v < 300; ++v) {
+            std::wstring         s(1, static_cast<wchar_t>(v));
+            InputStream<wchar_t> A(s), B(s), C(s);
+            bool                 in_item = item.parse(A).has_value();
+            agree &= cls.parse(B).has_value() == in_item;
+            agree &= neg.parse(C).has_value() != in_item;
+        }
+        return agree;
+    };
+    CHECK(check(CharRng<'\x80', '\xff'>{}));
+    CHECK(check(CharRng<'\x90', '\x10'>{}));
+    CHECK(check(CharRng<'a', 'z'>{}));
+    CHECK(check(AnyChar<'"', '\xe9'>{}));
+    CHECK(check(Char<'\xff'>));
+
+    // OrRule dispatch must not rule the class out on those chars.
+    auto item = CharRng<'\x80', '\xff'>{};
+    auto rule = negate(item) | memo(Char<'q'>);
+
+    std::wstring         s(1, wchar_t(0xc8));
+    InputStream<wchar_t> S(s), T(s);
+    bool                 in_item = item.parse(T).has_value();
+    CHECK(rule.parse(S).index() == (in_item ? 0 : 1));
+}
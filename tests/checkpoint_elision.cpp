@@ -0,0 +1,74 @@
+#include "catch.hpp"
+#include "cppeg.hpp"
+
+using namespace cppeg;
+
+namespace {
+// Counts the checkpoints Rule::parse asks for.
+class CountingStream : public InputStream<char> {
+public:
+    using InputStream<char>::InputStream;
+
+    checkpoint_type checkpoint() {
+        ++checkpoints;
+        return InputStream<char>::checkpoint();
+    }
+
+    int checkpoints = 0;
+};
+} // namespace
+
+TEST_CASE("Checkpoint elision: traits") {
+
+    CHECK(CharRule<'a'>::restores_on_failure);
+    CHECK((CharRng<'a', 'z'>::restores_on_failure));
+    CHECK((AnyChar<'a', 'b'>::restores_on_failure));
+    CHECK(Literal::restores_on_failure);
+
+    using ab = AndRule<CharRule<'a'>, CharRule<'b'>>;
+    CHECK(ab::restores_on_failure == false);
+    CHECK(AndRule<CharRule<'a'>>::restores_on_failure);
+    CHECK((OrRule<ab, CharRule<'c'>>::restores_on_failure));
+    CHECK(DiscardRule<ab>::restores_on_failure);
+}
+
+TEST_CASE("Checkpoint elision: simple subtrees need no checkpoints") {
+
+    std::string    s = "abcab";
+    CountingStream S(s);
+
+    auto alt = ~(Char<'a'> | Char<'b'> | "c"_L | AnyChar<'x', 'y'>{});
+    for (int i = 0; i < 5; ++i) {
+        CHECK(parse_success(alt.parse(S)));
+    }
+    CHECK(parse_success(alt.parse(S)) == false);
+    CHECK(S.checkpoints == 0);
+}
+
+TEST_CASE("Checkpoint elision: sequences checkpoint once") {
+
+    std::string    s = "abac";
+    CountingStream S(s);
+
+    auto ab = Char<'a'> + Char<'b'>;
+    CHECK(ab.parse(S).has_value());
+    CHECK(S.checkpoints == 1);
+
+    CHECK(ab.parse(S).has_value() == false);
+    CHECK(S.checkpoints == 2);
+    CHECK(S.get_pos() == 2);
+}
+
+TEST_CASE("Checkpoint elision: failure leaves skipped whitespace alone") {
+
+    std::string   s = "   b";
+    InputStream<> S(s, true);
+
+    auto a = Char<'a'>;
+    CHECK(a.parse(S).has_value() == false);
+    CHECK(S.get_pos() == 0);
+
+    auto b = Char<'b'>;
+    CHECK(b.parse(S).has_value());
+    CHECK(S.get_pos() == 4);
+}
@@ -0,0 +1,116 @@
+#include "catch.hpp"
+#include "cppeg.hpp"
+
+using namespace cppeg;
+using detail::CharTable;
+using detail::FirstSet;
+
+namespace {
+
+// Counts how often it is actually tried; fails without consuming.
+template<char C>
+struct Probe : public Rule<Probe<C>> {
+    static constexpr bool restores_on_failure = true;
+    static constexpr FirstSet first_set() {
+        return {CharTable{}.set(static_cast<unsigned char>(C))};
+    }
+
+    template<typename Stream>
+    std::optional<char> parse_impl(Stream &) {
+        ++*tries;
+        return std::nullopt;
+    }
+
+    int *tries;
+};
+
+} // namespace
+
+TEST_CASE("FirstSet: leaf rules") {
+
+    constexpr auto a = CharRule<'a'>::first_set();
+    CHECK(a.chars.test('a'));
+    CHECK_FALSE(a.chars.test('b'));
+    CHECK_FALSE(a.nullable);
+
+    constexpr auto get = decltype("GET"_lit)::first_set();
+    CHECK(get.chars == CharTable{}.set('G'));
+
+    CHECK(Literal::first_set().nullable); // runtime text: unknown
+    CHECK(StaticLiteral<>::first_set().nullable);
+
+    CHECK(a.cheap_reject);
+    CHECK_FALSE(MemoRule<CharRule<'a'>>::first_set().cheap_reject);
+}
+
+TEST_CASE("FirstSet: sequences, alternatives and repetition") {
+
+    using opt_sign = RepeatRule<AnyChar<'+', '-'>, 0, 1>;
+    using digit    = CharRng<'0', '9'>;
+
+    constexpr auto num = AndRule<opt_sign, digit>::first_set();
+    CHECK(num.chars == (CharTable{}.set('+').set('-').set_range('0', '9')));
+    CHECK_FALSE(num.nullable);
+
+    constexpr auto alt = OrRule<CharRule<'x'>, opt_sign>::first_set();
+    CHECK(alt.chars.test('x'));
+    CHECK(alt.nullable);
+
+    constexpr auto star = RepeatRule<digit, 0, unbounded>::first_set();
+    CHECK(star.nullable);
+}
+
+TEST_CASE("OrRule: alternatives that cannot match are not tried") {
+
+    int  tries_x = 0, tries_y = 0;
+    auto x       = Probe<'x'>{};
+    auto y       = Probe<'y'>{};
+    x.tries      = &tries_x;
+    y.tries      = &tries_y;
+
+    auto alt = x | y | Char<'y'> | Lit<'z', 'z'>;
+
+    std::string   s = "yzz";
+    InputStream<> S(s);
+
+    auto r1 = alt.parse(S);
+    CHECK(r1.index() == 1); // Char<'y'>, as char
+    CHECK(tries_x == 0);
+    CHECK(tries_y == 1);
+
+    auto r2 = alt.parse(S);
+    CHECK(std::get<std::string_view>(r2) == "zz");
+    CHECK(tries_x == 0);
+    CHECK(tries_y == 1);
+
+    // end of input: nothing is viable
+    CHECK_FALSE(parse_success(alt.parse(S)));
+    CHECK(tries_x == 0);
+    CHECK(tries_y == 1);
+}
+
+TEST_CASE("OrRule: dispatch keeps skipped whitespace unconsumed") {
+
+    std::string   s = "  b";
+    InputStream<> S(s, true);
+
+    auto alt = memo(Char<'a'>) | memo(Lit<'c', 'd'>);
+    CHECK_FALSE(parse_success(alt.parse(S)));
+    CHECK(S.get_pos() == 0);
+
+    auto alt2 = memo(Char<'a'>) | memo(Char<'b'>);
+    CHECK(parse_success(alt2.parse(S)));
+    CHECK(S.get_pos() == 3);
+}
+
+TEST_CASE("OrRule: nullable and unknown alternatives are always tried") {
+
+    std::string   s = "q";
+    InputStream<> S(s);
+
+    auto alt = Char<'a'> | "q"_L;
+    CHECK(std::get<std::string>(alt.parse(S)) == "q");
+
+    auto alt2 = Char<'a'> | *Char<'b'>;
+    CHECK(parse_success(alt2.parse(S))); // empty repetition
+}
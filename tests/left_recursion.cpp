@@ -0,0 +1,95 @@
+#include "catch.hpp"
+#include "cppeg.hpp"
+
+using namespace cppeg;
+
+namespace {
+
+auto number() {
+    auto to_long = [](auto const &digits) {
+        long v = 0;
+        for (char c : *digits) {
+            v = v * 10 + (c - '0');
+        }
+        return v;
+    };
+    return (+CharRng<'0', '9'>{})[to_long];
+}
+
+auto subtract = [](auto const &t) {
+    auto [lhs, op, rhs] = *t;
+    (void)op;
+    return lhs - rhs;
+};
+
+} // namespace
+
+TEST_CASE("LeftRecursive: left-associative result") {
+
+    auto                num = number();
+    LeftRecursive<long> expr;
+    expr.define((expr + Char<'-'> + num)[subtract] | num);
+
+    std::string   s = "10-3-2";
+    InputStream<> S(s);
+
+    auto ret = expr.parse(S);
+    REQUIRE(ret.has_value());
+    CHECK(*ret == 5);
+    CHECK(S.get_pos() == 6);
+}
+
+TEST_CASE("LeftRecursive: failure and partial match") {
+
+    auto                num = number();
+    LeftRecursive<long> expr;
+    expr.define((expr + Char<'-'> + num)[subtract] | num);
+
+    std::string   s = "x7-";
+    InputStream<> S(s);
+
+    CHECK(expr.parse(S).has_value() == false);
+    CHECK(S.get_pos() == 0);
+
+    auto x = Char<'x'>;
+    CHECK(x.parse(S).has_value());
+    auto ret = expr.parse(S);
+    REQUIRE(ret.has_value());
+    CHECK(*ret == 7);
+    CHECK(S.get_pos() == 2);
+}
+
+TEST_CASE("LeftRecursive: each operand is parsed once per step") {
+
+    int  calls = 0;
+    auto count = [&](auto const &v) {
+        ++calls;
+        return *v;
+    };
+    auto                num = number()[count];
+    LeftRecursive<long> expr;
+    expr.define((expr + Char<'-'> + num)[subtract] | num);
+
+    std::string   s = "1-2-3-4";
+    InputStream<> S(s);
+
+    CHECK(expr.parse(S) == -8);
+    // one parse per number, plus the final attempt that stops growing
+    CHECK(calls == 5);
+}
+
+TEST_CASE("LeftRecursive: recursion in non-left position") {
+
+    auto                num = number();
+    LeftRecursive<long> expr;
+    LeftRecursive<long> primary;
+    auto inner = [](auto const &t) { return std::get<1>(*t); };
+    primary.define((Char<'('> + expr + Char<')'>)[inner] | num);
+    expr.define((expr + Char<'-'> + primary)[subtract] | primary);
+
+    std::string   s = "8-(4-1)-2";
+    InputStream<> S(s);
+
+    CHECK(expr.parse(S) == 3);
+    CHECK(S.get_pos() == s.size());
+}
@@ -0,0 +1,130 @@
+#include "catch.hpp"
+#include "cppeg.hpp"
+
+using namespace cppeg;
+
+TEST_CASE("LiteralSet: | of literals folds into one set") {
+
+    auto kw = "select"_L | "insert"_L | "update"_L;
+    CHECK((std::is_same_v<decltype(kw), LiteralSet<>>));
+    CHECK((kw.literals() ==
+           std::vector<std::string>{"select", "insert", "update"}));
+
+    auto mixed = "a"_Lv | "b"_lit | "c"_L;
+    CHECK((mixed.literals() == std::vector<std::string>{"a", "b", "c"}));
+
+    std::string   s = "updateselectdelete";
+    InputStream<> S(s);
+
+    auto r1 = kw.parse(S);
+    REQUIRE(r1.has_value());
+    CHECK(r1->index == 2);
+    CHECK(r1->span == "update");
+    CHECK(r1->span.data() == s.data());
+
+    auto r2 = kw.parse(S);
+    REQUIRE(r2.has_value());
+    CHECK(r2->index == 0);
+    CHECK(S.get_pos() == 12);
+
+    CHECK(kw.parse(S).has_value() == false);
+    CHECK(S.get_pos() == 12);
+}
+
+TEST_CASE("LiteralSet: first and longest match") {
+
+    std::string s = "insertion";
+
+    // Same choice as the OrRule it replaces: the first that matches.
+    {
+        InputStream<> S(s);
+        auto          kw  = "in"_L | "insert"_L | "ins"_L;
+        auto          ret = kw.parse(S);
+        REQUIRE(ret.has_value());
+        CHECK(ret->index == 0);
+        CHECK(S.get_pos() == 2);
+    }
+    {
+        InputStream<> S(s);
+        auto          kw  = "ins"_L | "insert"_L | "in"_L;
+        auto          ret = kw.parse(S);
+        REQUIRE(ret.has_value());
+        CHECK(ret->index == 0);
+        CHECK(ret->span == "ins");
+    }
+    {
+        InputStream<> S(s);
+        auto          kw  = longest("in"_L | "insert"_L | "ins"_L);
+        auto          ret = kw.parse(S);
+        REQUIRE(ret.has_value());
+        CHECK(ret->index == 1);
+        CHECK(ret->span == "insert");
+        CHECK(S.get_pos() == 6);
+    }
+}
+
+TEST_CASE("LiteralSet: prefixes, duplicates and the empty literal") {
+
+    std::string   s = "ab";
+    InputStream<> S(s);
+
+    LiteralSet<> set{"abc", "a", "a"};
+    auto         ret = set.parse(S);
+    REQUIRE(ret.has_value());
+    CHECK(ret->index == 1); // "abc" runs past the end
+    CHECK(S.get_pos() == 1);
+
+    LiteralSet<> with_empty{"x", ""};
+    ret = with_empty.parse(S);
+    REQUIRE(ret.has_value());
+    CHECK(ret->index == 1);
+    CHECK(S.get_pos() == 1);
+}
+
+TEST_CASE("LiteralSet: skipped whitespace") {
+
+    std::string   s = "  let  x";
+    InputStream<> S(s, true);
+
+    auto kw  = "let"_L | "var"_L;
+    auto ret = kw.parse(S);
+    REQUIRE(ret.has_value());
+    CHECK(ret->span == "let");
+
+    CHECK(kw.parse(S).has_value() == false);
+    CHECK(S.get_pos() == 5);
+}
+
+TEST_CASE("LiteralSet: wide streams") {
+
+    auto verb = "GET"_lit | "PUT"_lit;
+
+    std::wstring         s = L"PUT /";
+    InputStream<wchar_t> S(s);
+
+    auto ret = verb.parse(S);
+    REQUIRE(ret.has_value());
+    CHECK((std::is_same_v<decltype(ret->span), std::wstring_view>));
+    CHECK(ret->index == 1);
+    CHECK(ret->span == L"PUT");
+
+    // U+0147 has 'G' as its low byte but is no char of "GET".
+    std::wstring         w = L"ŇET";
+    InputStream<wchar_t> W(w);
+    CHECK(verb.parse(W).has_value() == false);
+    CHECK(W.get_pos() == 0);
+}
+
+TEST_CASE("LiteralSet: a chain of | shares one growing set") {
+
+    auto kw   = "a"_L | "b"_L | "c"_L | "d"_L;
+    auto copy = kw;
+    auto more = copy | "e"_L; // copy is left as it was
+    CHECK((copy.literals() == std::vector<std::string>{"a", "b", "c", "d"}));
+    CHECK(more.literals().size() == 5);
+
+    std::string   s = "e";
+    InputStream<> S(s);
+    CHECK(kw.parse(S).has_value() == false);
+    CHECK(more.parse(S).has_value());
+}
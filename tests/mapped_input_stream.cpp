@@ -0,0 +1,95 @@
+#include "catch.hpp"
+#include "cppeg.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+#include <unistd.h>
+
+using namespace cppeg;
+
+namespace {
+
+// A file with the given contents under the system's temp directory,
+// named uniquely per process and test so parallel runs do not clash.
+// Removed on destruction.
+class TempFile {
+public:
+    explicit TempFile(std::string const &contents) {
+        static int count = 0;
+        path = (std::filesystem::temp_directory_path() /
+                ("cppeg_mapped_test_" + std::to_string(::getpid()) + "_" +
+                 std::to_string(count++) + ".txt"))
+                   .string();
+        std::ofstream(path, std::ios::binary) << contents;
+    }
+    ~TempFile() {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+
+    TempFile(TempFile const &) = delete;
+    TempFile &operator=(TempFile const &) = delete;
+
+    std::string path;
+};
+
+} // namespace
+
+TEST_CASE("MappedInputStream: parse a file") {
+
+    TempFile file("abba");
+    {
+        MappedInputStream<> S(file.path);
+        CHECK(S.file_size() == 4);
+
+        auto parser = Char<'a'> + "bb"_L + Char<'a'>;
+        auto ret    = parser.parse(S);
+
+        auto answer = std::tuple<char, std::string, char>('a', "bb", 'a');
+        CHECK(ret.has_value());
+        CHECK(ret.value() == answer);
+        CHECK(S.distance_to_end() == 0);
+    }
+}
+
+TEST_CASE("MappedInputStream: failure does not advance") {
+
+    TempFile file("abba");
+    {
+        MappedInputStream<> S(file.path);
+
+        auto ret = (Char<'a'> + Char<'c'>).parse(S);
+        CHECK(ret.has_value() == false);
+        CHECK(S.get_pos() == 0);
+    }
+}
+
+TEST_CASE("MappedInputStream: empty and missing files") {
+
+    TempFile file("");
+    {
+        MappedInputStream<> S(file.path);
+        CHECK(S.file_size() == 0);
+        auto a = Char<'a'>;
+        CHECK(a.parse(S).has_value() == false);
+    }
+
+    CHECK_THROWS_AS(MappedInputStream<>("/nonexistent/cppeg/file"),
+                    std::system_error const &);
+}
+
+TEST_CASE("MappedInputStream: results policy") {
+
+    TempFile file("aab");
+    {
+        MappedInputStream<char, NoSkip, ArenaResults> S(file.path);
+        auto ret = (*Char<'a'>).parse(S);
+        REQUIRE(ret.has_value());
+        CHECK((std::is_same_v<std::decay_t<decltype(*ret)>,
+                              std::pmr::vector<char>>));
+        CHECK(ret->size() == 2);
+    }
+}
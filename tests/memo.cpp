@@ -0,0 +1,123 @@
+#include "catch.hpp"
+#include "cppeg.hpp"
+
+using namespace cppeg;
+
+TEST_CASE("Memo: alternatives sharing a prefix parse it once") {
+
+    std::string   s = "aaab";
+    InputStream<> S(s);
+
+    int  calls = 0;
+    auto count = [&](auto const &) { ++calls; };
+    auto as    = memo(+Char<'a'>[count]);
+    auto alt   = (as + Char<'x'>) | (as + Char<'b'>);
+
+    CHECK(parse_success(alt.parse(S)));
+    CHECK(calls == 3);
+    CHECK(S.get_pos() == 4);
+}
+
+TEST_CASE("Memo: failures are replayed too") {
+
+    std::string   s = "ab";
+    InputStream<> S(s);
+
+    int  calls = 0;
+    auto count = [&](auto const &) { ++calls; };
+    auto x     = memo(Char<'a'>[count] + Char<'y'>);
+
+    CHECK(x.parse(S).has_value() == false);
+    CHECK(x.parse(S).has_value() == false);
+    CHECK(calls == 1);
+    CHECK(S.get_pos() == 0);
+}
+
+TEST_CASE("Memo: stateless rules are keyed by type") {
+
+    std::string   s = "abc";
+    InputStream<> S(s);
+
+    using ab_result = std::optional<std::tuple<char, char>>;
+    auto &table     = S.context().memo_table<ab_result>();
+
+    auto a1 = memo(Char<'a'> + Char<'b'>);
+    auto a2 = memo(Char<'a'> + Char<'b'>);
+
+    auto start = S.checkpoint();
+    CHECK(a1.parse(S).has_value());
+    S.restore(start);
+    CHECK(a2.parse(S).has_value());
+    CHECK(S.get_pos() == 2);
+    CHECK(table.size() == 1);
+
+    // Literal holds its text, so each instance gets its own key.
+    using lit_result = std::optional<std::string>;
+    auto &lit_table  = S.context().memo_table<lit_result>();
+
+    auto l1 = memo("c"_L);
+    auto l2 = memo("c"_L);
+    start   = S.checkpoint();
+    CHECK(l1.parse(S).has_value());
+    S.restore(start);
+    CHECK(l2.parse(S).has_value());
+    CHECK(lit_table.size() == 2);
+}
+
+TEST_CASE("Memo: table capacity is bounded") {
+
+    std::string   s(1000, 'a');
+    InputStream<> S(s);
+    S.context().set_memo_capacity(50);
+
+    auto a    = memo(Char<'a'>);
+    auto all  = *a;
+    auto &tbl = S.context().memo_table<std::optional<char>>();
+    CHECK(tbl.capacity() == 64);
+
+    CHECK(all.parse(S)->size() == 1000);
+    CHECK(S.get_pos() == 1000);
+    CHECK(tbl.size() <= 64);
+}
+
+TEST_CASE("Memo: evicted entries are parsed again") {
+
+    std::string   s = "ab";
+    InputStream<> S(s);
+    S.context().set_memo_capacity(1);
+
+    int  calls  = 0;
+    auto count  = [&](auto const &) { ++calls; };
+    auto ignore = [](auto const &) {};
+    auto a      = memo(Char<'a'>[count]);
+    auto b      = memo(Char<'b'>[ignore]); // same result type, same table
+
+    auto start = S.checkpoint();
+    CHECK(a.parse(S).has_value());
+    CHECK(b.parse(S).has_value());
+    S.restore(start);
+    // b's entry took the only slot
+    CHECK(a.parse(S).has_value());
+    CHECK(calls == 2);
+    CHECK(S.get_pos() == 1);
+}
+
+TEST_CASE("Memo: low water mark ignores plain seeks") {
+
+    std::string   s = "abcd";
+    InputStream<> S(s);
+
+    // restore() without a checkpoint is just a seek.
+    S.restore(3);
+    CHECK(S.low_water() == 3);
+    S.restore(1);
+    CHECK(S.low_water() == 1);
+
+    // Inside a sequence, the mark stays at its start.
+    std::size_t seen = 0;
+    auto        mark = [&](auto const &) { seen = S.low_water(); };
+    auto        seq  = Char<'b'> + Char<'c'>[mark] + Char<'d'>;
+    CHECK(seq.parse(S).has_value());
+    CHECK(seen == 1);
+    CHECK(S.low_water() == 4);
+}
@@ -0,0 +1,146 @@
+#include "catch.hpp"
+#include "cppeg.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+using namespace cppeg;
+
+namespace {
+
+template<typename R>
+auto parse_all(R rule, std::string const &s) {
+    InputStream<> S(s);
+    auto          ret = rule.parse(S);
+    if (S.distance_to_end() != 0) {
+        ret.reset();
+    }
+    return ret;
+}
+
+} // namespace
+
+TEST_CASE("Int: values and widths") {
+    CHECK(parse_all(Int<int>, "0") == 0);
+    CHECK(parse_all(Int<int>, "42") == 42);
+    CHECK(parse_all(Int<int>, "-42") == -42);
+    CHECK(parse_all(Int<int>, "000123") == 123);
+
+    // Long enough for the eight-digit path, with a scalar tail.
+    CHECK(parse_all(Int<std::uint64_t>, "1234567890123") == 1234567890123u);
+    CHECK(parse_all(Int<std::int64_t>, "-9223372036854775808") ==
+          std::numeric_limits<std::int64_t>::min());
+    CHECK(parse_all(Int<std::uint64_t>, "18446744073709551615") ==
+          std::numeric_limits<std::uint64_t>::max());
+
+    CHECK(parse_all(Int<std::int8_t>, "127") == 127);
+    CHECK(parse_all(Int<std::int8_t>, "-128") == -128);
+    CHECK(parse_all(Int<std::uint16_t>, "65535") == 65535);
+}
+
+TEST_CASE("Int: overflow and bad input do not match") {
+    std::string   s = "256 x -1 18446744073709551616";
+    InputStream<> S(s, true);
+    S.context().failures().enable();
+
+    auto i8  = Int<std::int8_t>;
+    auto u8  = Int<std::uint8_t>;
+    auto i32 = Int<int>;
+    auto u32 = Int<unsigned>;
+    auto u64 = Int<std::uint64_t>;
+
+    CHECK(u8.parse(S).has_value() == false);
+    CHECK(S.get_pos() == 0);
+    CHECK(i32.parse(S) == 256);
+
+    CHECK(i32.parse(S).has_value() == false); // 'x'
+    CHECK(S.get_pos() == 3);
+    S.getChar();
+
+    CHECK(u32.parse(S).has_value() == false); // no sign
+    CHECK(i32.parse(S) == -1);
+
+    CHECK(u64.parse(S).has_value() == false);
+    CHECK(i8.parse(S).has_value() == false);
+    CHECK(S.context().failures().farthest() == 8);
+
+    CHECK(parse_all(Int<int>, "-").has_value() == false);
+    CHECK(parse_all(Int<std::int8_t>, "-129").has_value() == false);
+}
+
+TEST_CASE("Int: in sequences") {
+    std::string   s    = "host:8080";
+    InputStream<> S(s);
+    auto          port = span(+CharRng<'a', 'z'>{}) + ~Char<':'> +
+                Int<std::uint16_t>;
+    auto ret = port.parse(S);
+    REQUIRE(ret.has_value());
+    CHECK(std::get<0>(*ret) == "host");
+    CHECK(std::get<1>(*ret) == 8080);
+}
+
+TEST_CASE("Float: syntax") {
+    CHECK(parse_all(Float<double>, "1") == 1.0);
+    CHECK(parse_all(Float<double>, "-2.5") == -2.5);
+    CHECK(parse_all(Float<double>, ".5") == 0.5);
+    CHECK(parse_all(Float<double>, "1e3") == 1000.0);
+    CHECK(parse_all(Float<double>, "1.5E-2") == 0.015);
+    CHECK(parse_all(Float<double>, "6.02e+23") == 6.02e23);
+
+    // A trailing '.' or exponent marker is not part of the number.
+    std::string   s = "2.x 3e+y";
+    InputStream<> S(s, true);
+    auto          number = Float<double>;
+    CHECK(number.parse(S) == 2.0);
+    CHECK(S.get_pos() == 1);
+    S.getChar();
+    S.getChar();
+    CHECK(number.parse(S) == 3.0);
+    CHECK(S.get_pos() == 5);
+
+    CHECK(parse_all(Float<double>, "-").has_value() == false);
+    CHECK(parse_all(Float<double>, ".").has_value() == false);
+    CHECK(parse_all(Float<double>, "1e999").has_value() == false);
+}
+
+TEST_CASE("Float: correctly rounded on both paths") {
+    // fast path
+    CHECK(parse_all(Float<double>, "0.1") == 0.1);
+    CHECK(parse_all(Float<double>, "123456.789") == 123456.789);
+    CHECK(parse_all(Float<float>, "3.14159") == 3.14159f);
+
+    // too many digits or too large an exponent for it
+    CHECK(parse_all(Float<double>, "3.141592653589793238462643383279") ==
+          3.141592653589793);
+    CHECK(parse_all(Float<double>, "1.7976931348623157e308") ==
+          std::numeric_limits<double>::max());
+    CHECK(parse_all(Float<double>, "4.9406564584124654e-324") ==
+          std::numeric_limits<double>::denorm_min());
+    CHECK(parse_all(Float<float>, "1e-30") == 1e-30f);
+
+    auto neg_zero = parse_all(Float<double>, "-0.0");
+    REQUIRE(neg_zero.has_value());
+    CHECK(std::signbit(*neg_zero));
+}
+
+TEST_CASE("Numbers: longer than the lookahead window") {
+    std::string digits(100, '1');
+    CHECK(parse_all(Float<double>, digits + ".5e-90") ==
+          std::stod(digits + ".5e-90"));
+    CHECK(parse_all(Int<std::uint64_t>, std::string(90, '0') + "7") == 7);
+}
+
+TEST_CASE("Numbers: in alternatives") {
+    std::string   s = "[1,-2.5,x]";
+    InputStream<> S(s);
+
+    auto item   = Int<int> | Float<double>;
+    auto parser = ~Char<'['> + item + ~Char<','> + Float<double> +
+                  ~Char<','> + (item | ~Char<'x'>) + ~Char<']'>;
+    auto ret = parser.parse(S);
+    REQUIRE(ret.has_value());
+    CHECK(std::get<int>(std::get<0>(*ret)) == 1);
+    CHECK(std::get<1>(*ret) == -2.5);
+}
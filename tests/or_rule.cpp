@@ -43,3 +43,49 @@ TEST_CASE("OrRule test: Two different types") {
 
     std::cout << helpers::type_name<std::decay_t<decltype(ret3)>>() << "\n";
 }
+
+TEST_CASE("OrRule test: nested OrRule stops at first success") {
+
+    std::string s = "aab";
+    InputStream<> S(s);
+
+    auto nested = (Char<'a'> | Char<'x'>) + Char<'b'>;
+    auto ret = nested.parse(S);
+    CHECK(ret.has_value() == false);
+
+    auto nested2 = Char<'a'> + (Char<'a'> | Char<'x'>) + Char<'b'>;
+    auto ret1 = nested2.parse(S);
+    CHECK(ret1.has_value());
+    CHECK(std::get<char>(std::get<1>(ret1.value())) == 'a');
+
+    S.restore(0);
+    auto alt = Or(Or(Char<'a'>, Char<'x'>), Char<'a'> + Char<'b'>);
+    auto ret2 = alt.parse(S);
+    CHECK(parse_success(ret2));
+    CHECK(S.get_pos() == 1);
+}
+
+namespace {
+// Or of Char<1 + I>... (control chars and punctuation), then last.
+template<typename Last, std::size_t... I>
+auto many_chars(Last const &last, std::index_sequence<I...>) {
+    return Or(Char<static_cast<char>(1 + I)>..., last);
+}
+} // namespace
+
+TEST_CASE("OrRule test: more alternatives than the dispatch mask holds") {
+
+    // 64 single chars, then a sequence: the 65th alternative.
+    auto rule =
+        many_chars(Char<'z'> + Char<'!'>, std::make_index_sequence<64>());
+
+    std::string s = "z!";
+    InputStream<> S(s);
+    auto ret = rule.parse(S);
+    CHECK(ret.index() == 2);
+    CHECK(S.get_pos() == 2);
+
+    std::string t = "@";
+    InputStream<> T(t);
+    CHECK(std::get<char>(rule.parse(T)) == '@');
+}
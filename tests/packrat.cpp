@@ -0,0 +1,62 @@
+#include "catch.hpp"
+#include "cppeg.hpp"
+
+using namespace cppeg;
+
+TEST_CASE("Packrat: alternatives sharing a prefix parse it once") {
+
+    std::string s = "aaab";
+
+    int  calls = 0;
+    auto count = [&](auto const &) { ++calls; };
+    auto as    = +Char<'a'>[count];
+
+    // Without memoization the shared prefix is parsed by both
+    // alternatives.
+    {
+        InputStream<> S(s);
+        auto          alt = (as + Char<'x'>) | (as + Char<'b'>);
+        CHECK(parse_success(alt.parse(S)));
+        CHECK(calls == 6);
+    }
+
+    calls = 0;
+    {
+        InputStream<> S(s);
+        auto          memo_as = packrat(as);
+        auto          alt     = (memo_as + Char<'x'>) | (memo_as + Char<'b'>);
+        CHECK(parse_success(alt.parse(S)));
+        CHECK(calls == 3);
+        CHECK(S.get_pos() == 4);
+    }
+}
+
+TEST_CASE("Packrat: failures are replayed too") {
+
+    std::string   s = "ab";
+    InputStream<> S(s);
+
+    int  calls = 0;
+    auto count = [&](auto const &) { ++calls; };
+    auto x     = packrat(Char<'a'>[count] + Char<'y'>);
+
+    CHECK(x.parse(S).has_value() == false);
+    CHECK(x.parse(S).has_value() == false);
+    CHECK(calls == 1);
+    CHECK(S.get_pos() == 0);
+}
+
+TEST_CASE("Packrat: replayed result and position") {
+
+    std::string   s = "abba";
+    InputStream<> S(s);
+
+    auto abb = packrat(Char<'a'> + "bb"_L);
+    auto r1  = abb.parse(S);
+    CHECK(S.get_pos() == 3);
+
+    S.restore(0);
+    auto r2 = abb.parse(S);
+    CHECK(S.get_pos() == 3);
+    CHECK(r1 == r2);
+}
@@ -0,0 +1,181 @@
+#include "catch.hpp"
+#include "cppeg.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cppeg;
+
+namespace {
+
+using Stream = InputStream<char, NoSkip>;
+
+// "key=value" records, where value is an integer; line i holds
+// "k<i>=<i>" except every 1000th, which is malformed.
+std::string make_lines(int n, char delimiter) {
+    std::string out;
+    for (int i = 0; i < n; ++i) {
+        out += 'k' + std::to_string(i) + (i % 1000 == 999 ? ":" : "=") +
+               std::to_string(i) + delimiter;
+    }
+    return out;
+}
+
+auto pair_grammar() {
+    auto value = [](auto &v) { return std::get<0>(*v); };
+    return (~span(+~CharRng<'a', 'z'>{} + ~+~CharRng<'0', '9'>{}) +
+            ~Char<'='> + Int<int>)[value];
+}
+
+} // namespace
+
+TEST_CASE("parse_records: results in input order") {
+    // Large enough for many chunks.
+    auto text = make_lines(100000, '\n');
+    REQUIRE(text.size() > 64 * detail::min_chunk_bytes);
+
+    for (unsigned threads : {1u, 2u, 7u}) {
+        auto results = parse_records<Stream>(pair_grammar(), text, '\n',
+                                             threads);
+        REQUIRE(results.size() == 100000);
+        bool in_order = true;
+        for (int i = 0; i < 100000; ++i) {
+            if (i % 1000 == 999) {
+                in_order &= !results[i].has_value();
+            } else {
+                in_order &= results[i] == i;
+            }
+        }
+        CHECK(in_order);
+    }
+}
+
+TEST_CASE("parse_records: records must match in full") {
+    std::string text = "a1=1\nb2=2x\n\nc3=3";
+    auto results = parse_records<Stream>(pair_grammar(), text);
+    REQUIRE(results.size() == 4);
+    CHECK(results[0] == 1);
+    CHECK(results[1].has_value() == false);
+    CHECK(results[2].has_value() == false); // the empty record
+    CHECK(results[3] == 3);
+
+    // Trailing skipped chars are allowed.
+    std::string spaced = "a1 = 1 ;b2=2;";
+    auto        ws     = parse_records<InputStream<char, SkipWhitespace>>(
+        pair_grammar(), spaced, ';');
+    REQUIRE(ws.size() == 2);
+    CHECK(ws[0] == 1);
+    CHECK(ws[1] == 2);
+
+    CHECK(parse_records<Stream>(pair_grammar(), "").empty());
+}
+
+TEST_CASE("parse_records: sink sees records in order") {
+    auto text = make_lines(50000, ';');
+
+    std::vector<std::string_view> records;
+    std::int64_t                  sum = 0;
+    auto sink = [&](std::string_view record, std::optional<int> &&v) {
+        records.push_back(record);
+        sum += v.value_or(0);
+    };
+    parse_records<Stream>(pair_grammar(), text, sink, ';', 4);
+
+    REQUIRE(records.size() == 50000);
+    CHECK(records.front() == "k0=0");
+    CHECK(records[1234] == "k1234=1234");
+    CHECK(records[49998] == "k49998=49998");
+    CHECK(records.back() == "k49999:49999");
+
+    std::int64_t expected = 0;
+    for (int i = 0; i < 50000; ++i) {
+        expected += i % 1000 == 999 ? 0 : i;
+    }
+    CHECK(sum == expected);
+}
+
+TEST_CASE("parse_records: workers wait for a slow sink") {
+    auto     text    = make_lines(100000, '\n');
+    unsigned threads = 4;
+
+    // The most records a chunk can hold.
+    std::size_t per_chunk = 0;
+    for (auto chunk : detail::split_chunks(
+             text, '\n', threads * detail::chunks_per_thread)) {
+        per_chunk = std::max<std::size_t>(
+            per_chunk, std::count(chunk.begin(), chunk.end(), '\n'));
+    }
+
+    std::atomic<std::size_t> parsed{0};
+    auto count   = [&](auto &) { parsed.fetch_add(1); };
+    auto grammar = pair_grammar()[count];
+
+    // parsed leaves out the malformed records, hence signed.
+    std::int64_t sunk = 0, ahead = 0;
+    auto sink = [&](std::string_view, auto &&) {
+        ahead = std::max(ahead, static_cast<std::int64_t>(parsed.load()) - sunk);
+        if (sunk++ == 0) {
+            // Plenty of time to parse everything, if nothing stopped it.
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }
+    };
+    parse_records<Stream>(grammar, text, sink, '\n', threads);
+
+    REQUIRE(sunk == 100000);
+    // The chunk being sunk, plus the window past it.
+    CHECK(ahead <= static_cast<std::int64_t>(
+                       (threads * detail::chunks_ahead_per_thread + 1) *
+                       per_chunk));
+}
+
+TEST_CASE("parse_records: shared RuleRef grammar and alternatives") {
+    RuleRef<int, Stream> list;
+    auto nested = [](auto &v) { return std::get<0>(*v) + 1; };
+    auto leaf   = [](auto &) { return 0; };
+    list.define((~Char<'('> + list + ~Char<')'>)[nested] | Char<'x'>[leaf]);
+
+    std::string text;
+    for (int i = 0; i < 20000; ++i) {
+        text += std::string(i % 7, '(') + 'x' + std::string(i % 7, ')') +
+                '\n';
+    }
+    auto results = parse_records<Stream>(list, text, '\n', 3);
+    REQUIRE(results.size() == 20000);
+    bool ok = true;
+    for (int i = 0; i < 20000; ++i) {
+        ok &= results[i] == i % 7;
+    }
+    CHECK(ok);
+
+    auto item    = Int<int> | Char<'x'>;
+    auto choices = parse_records<Stream>(item, "x\n7\nz");
+    REQUIRE(choices.size() == 3);
+    CHECK(choices[0].index() == 2);
+    CHECK(choices[1].index() == 1);
+    CHECK(choices[2].index() == 0);
+}
+
+TEST_CASE("parse_records: exceptions reach the caller") {
+    auto text  = make_lines(100000, '\n');
+    auto check = [](auto &v) {
+        if (*v == 77777) {
+            throw std::runtime_error("77777");
+        }
+    };
+    auto grammar = pair_grammar()[check];
+    CHECK_THROWS_AS(parse_records<Stream>(grammar, text, '\n', 4),
+                    std::runtime_error const &);
+
+    auto throwing_sink = [](std::string_view, auto &&) {
+        throw std::runtime_error("sink");
+    };
+    CHECK_THROWS_AS(
+        parse_records<Stream>(pair_grammar(), text, throwing_sink, '\n', 4),
+        std::runtime_error const &);
+}
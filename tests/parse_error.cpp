@@ -0,0 +1,213 @@
+#include "catch.hpp"
+#include "cppeg.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace cppeg;
+
+static_assert(rule_id<CharRule<'a'>> != rule_id<CharRule<'b'>>);
+static_assert(rule_id<CharRule<';'>> != rule_id<CharRule<','>>);
+static_assert(helpers::type_name<CharRule<';'>>() == "cppeg::CharRule<';'>");
+
+// clang's __PRETTY_FUNCTION__ format, parsed whichever compiler runs this.
+static_assert(helpers::pretty_type(
+                  "std::string_view cppeg::helpers::type_name() "
+                  "[T = cppeg::CharRule<']'>]",
+                  "[T = ", "]") == "cppeg::CharRule<']'>");
+static_assert(helpers::pretty_type("f()", "[T = ", "]") == "f()");
+static_assert(CharRng<'0', '9'>::expected_name() == "[0-9]");
+static_assert(decltype("let"_lit)::expected_name() == "\"let\"");
+static_assert(decltype(CharRng<'a', 'z'>{} | Char<'_'>)::expected_name() ==
+              "character class");
+static_assert(NotCharClass<CharRule<'"'>>::expected_name() ==
+              "character not in class");
+
+namespace {
+
+std::vector<std::string_view> expected(FailureSet const &f) {
+    std::vector<std::string_view> ret;
+    for (auto const *rule : f) {
+        ret.push_back(rule->name);
+    }
+    return ret;
+}
+
+} // namespace
+
+TEST_CASE("ParseError: farthest failure and its alternatives") {
+
+    auto rule = Char<'a'> + Char<'b'> + (Char<'c'> | Char<'d'>);
+
+    std::string   s = "abx";
+    InputStream<> S(s);
+    auto const   &f = S.context().failures();
+
+    // Nothing is recorded until tracking is enabled.
+    CHECK(rule.parse(S).has_value() == false);
+    CHECK(f.empty());
+
+    S.context().failures().enable();
+    CHECK(rule.parse(S).has_value() == false);
+    CHECK(S.get_pos() == 0);
+    REQUIRE(f.empty() == false);
+    CHECK(f.farthest() == 2);
+    CHECK((expected(f) == std::vector<std::string_view>{"'c'", "'d'"}));
+
+    auto e = parse_error(S);
+    CHECK(e.offset == 2);
+    CHECK(e.line == 1);
+    CHECK(e.column == 3);
+    CHECK(e.message() == "line 1, column 3: expected 'c' or 'd'");
+}
+
+TEST_CASE("ParseError: line and column") {
+
+    auto digits = ~+CharRng<'0', '9'>{};
+    auto ident  = ~+CharRng<'a', 'z'>{};
+    auto stmt   = "let"_lit + ident + Char<'='> + digits + Char<';'>;
+    auto program = *stmt + ~Char<'$'>;
+
+    std::string   s = "let x = 1;\nlet y = 22;\nlet = 3;$";
+    InputStream<> S(s, true);
+    S.context().failures().enable();
+    CHECK(program.parse(S).has_value() == false);
+
+    // The failure on line 3 is the farthest, even though the
+    // repetition succeeded and only the end marker failed. It is
+    // reported past the whitespace before it.
+    auto e = parse_error(S);
+    CHECK(e.offset == 27);
+    CHECK(e.line == 3);
+    CHECK(e.column == 5);
+    CHECK((e.expected == std::vector<std::string_view>{"[a-z]"}));
+}
+
+TEST_CASE("ParseError: earlier failures are dropped") {
+
+    auto rule = (Char<'x'> + Char<'y'>) | (Char<'x'> + Char<'z'> + Char<'!'>) |
+                Char<'w'>;
+
+    std::string   s = "xz?";
+    InputStream<> S(s);
+    S.context().failures().enable();
+    CHECK(rule.parse(S).index() == 0);
+
+    auto const &f = S.context().failures();
+    CHECK(f.farthest() == 2);
+    CHECK((expected(f) == std::vector<std::string_view>{"'!'"}));
+
+    // reset() before reusing the stream.
+    S.context().failures().reset();
+    CHECK(f.empty());
+    CHECK(f.enabled());
+    auto e = parse_error(S);
+    CHECK(e.offset == 0);
+    CHECK(e.expected.empty());
+    CHECK(e.message() == "line 1, column 1: syntax error");
+}
+
+TEST_CASE("ParseError: a repeated expectation is kept once") {
+
+    auto rule = (Char<'a'> + Char<'b'>) | (Char<'a'> + Char<'b'>) |
+                (Char<'a'> + Char<'c'>);
+
+    std::string   s = "ax";
+    InputStream<> S(s);
+    S.context().failures().enable();
+    CHECK(rule.parse(S).index() == 0);
+    CHECK((expected(S.context().failures()) ==
+           std::vector<std::string_view>{"'b'", "'c'"}));
+}
+
+TEST_CASE("ParseError: alternatives ruled out by OrRule's dispatch") {
+
+    // Int is not a cheap reject, so the OrRule dispatches on the next
+    // char and would not try either alternative on 'y'.
+    auto rule = "let"_lit + (Int<int> | Char<'('>);
+
+    std::string   s = "let y";
+    InputStream<> S(s, true);
+    S.context().failures().enable();
+    CHECK(rule.parse(S).has_value() == false);
+    CHECK(parse_error(S).message() ==
+          "line 1, column 5: expected integer or '('");
+
+    // Without tracking, the dispatch still picks the alternative.
+    std::string   t = "let (";
+    InputStream<> T(t, true);
+    CHECK(rule.parse(T).has_value());
+}
+
+TEST_CASE("ParseError: wide-char streams") {
+
+    auto rule = Char<'a'>;
+
+    std::wstring         s = L"\n\nz";
+    InputStream<wchar_t> S(s, true);
+    S.context().failures().enable();
+    CHECK(rule.parse(S).has_value() == false);
+
+    auto e = parse_error(S);
+    CHECK(e.offset == 2);
+    CHECK(e.line == 3);
+    CHECK(e.column == 1);
+    CHECK(e.message() == "line 3, column 1: expected 'a'");
+}
+
+TEST_CASE("ParseError: rules whose text is known at run time") {
+
+    Symbols<int> types{{"int", 4}, {"long", 8}};
+    auto         rule = "let"_L + ("x"_L | "y"_L) + types;
+
+    std::string   s = "let z";
+    InputStream<> S(s, true);
+    S.context().failures().enable();
+    CHECK(rule.parse(S).has_value() == false);
+    CHECK(parse_error(S).message() == "line 1, column 5: expected literal");
+
+    std::string   t = "let x char";
+    InputStream<> T(t, true);
+    T.context().failures().enable();
+    CHECK(rule.parse(T).has_value() == false);
+    CHECK(parse_error(T).message() == "line 1, column 7: expected symbol");
+}
+
+TEST_CASE("ParseError: token streams") {
+
+    enum Kind { word, comma };
+    auto lex = lexer(AnyChar<' ', '\n'>{}, token<word>(+CharRng<'a', 'z'>{}),
+                     token<comma>(Char<','>));
+    auto list = Tok<word> + *(Tok<comma> + Tok<word>) + Tok<comma>;
+
+    std::string s      = "ab, cd,\n, ef";
+    auto        tokens = lex.tokenize(s);
+    REQUIRE(tokens.size() == 6);
+
+    TokenStream S(s, tokens);
+    S.context().failures().enable();
+    auto ret = list.parse(S);
+    REQUIRE(ret.has_value());
+
+    // The trailing comma matched, so the farthest failure is the
+    // word expected after the second comma.
+    auto e = parse_error(S);
+    CHECK(e.offset == 8);
+    CHECK(e.line == 2);
+    CHECK(e.column == 1);
+    REQUIRE(e.expected.size() == 1);
+    CHECK(e.expected[0] == helpers::type_name<TokenRule<word>>());
+}
+
+TEST_CASE("ParseError: char classes") {
+
+    auto ident = CharRng<'a', 'z'>{} | Char<'_'>;
+    auto rule  = Char<'('> + ident;
+
+    std::string   s = "(1";
+    InputStream<> S(s);
+    S.context().failures().enable();
+    CHECK(rule.parse(S).has_value() == false);
+    CHECK(parse_error(S).message() ==
+          "line 1, column 2: expected character class");
+}
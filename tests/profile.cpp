@@ -0,0 +1,101 @@
+// Built into the separate profile_tests executable, with CPPEG_PROFILE
+// defined for every translation unit.
+
+#include "catch.hpp"
+#include "cppeg.hpp"
+
+#include <sstream>
+#include <string>
+
+using namespace cppeg;
+
+namespace {
+
+profile::Counters counters_of(std::string_view name) {
+    for (auto const &c : profile::registry().snapshot()) {
+        if (c.name == name) {
+            return c;
+        }
+    }
+    return profile::Counters{std::string(name)};
+}
+
+} // namespace
+
+TEST_CASE("profile: counts per rule type") {
+    profile::reset();
+
+    auto        ab = Char<'a'> + Char<'b'>;
+    std::string s  = "abab";
+    InputStream<> S(s);
+    CHECK(ab.parse(S).has_value());
+    CHECK(ab.parse(S).has_value());
+    CHECK(ab.parse(S).has_value() == false);
+
+    auto a = counters_of(helpers::type_name<CharRule<'a'>>());
+    CHECK(a.calls == 3);
+    CHECK(a.successes == 2);
+    CHECK(a.failures == 1);
+    CHECK(a.consumed == 2);
+
+    auto seq = counters_of(helpers::type_name<decltype(ab)>());
+    CHECK(seq.calls == 3);
+    CHECK(seq.successes == 2);
+    CHECK(seq.consumed == 4);
+}
+
+TEST_CASE("profile: named rules and backtracking") {
+    profile::reset();
+
+    auto assign = named("assign", Char<'x'> + Char<'='> + Char<'1'>);
+    auto call   = named("call", Char<'x'> + Char<'('> + Char<')'>);
+    auto stmt   = assign | call;
+
+    std::string   s = "x()x=1x(";
+    InputStream<> S(s);
+    S.context().failures().enable();
+    CHECK(stmt.parse(S).index() == 1);
+    CHECK(stmt.parse(S).index() == 1);
+    CHECK(stmt.parse(S).index() == 0);
+    CHECK(S.get_pos() == 6);
+
+    auto as = counters_of("assign");
+    CHECK(as.calls == 3);
+    CHECK(as.successes == 1);
+    CHECK(as.failures == 2);
+    CHECK(as.consumed == 3);
+    CHECK(as.backtracked == 2); // one 'x' each time
+
+    auto cl = counters_of("call");
+    CHECK(cl.calls == 2);
+    CHECK(cl.successes == 1);
+    CHECK(cl.failures == 1);
+    CHECK(cl.backtracked == 2); // "x(" at the end
+
+    // The name replaces the type name, and the failure tracking of the
+    // subrule is unaffected.
+    using inner = decltype(Char<'x'> + Char<'='> + Char<'1'>);
+    CHECK(counters_of(helpers::type_name<inner>()).calls == 0);
+    CHECK(S.context().failures().farthest() == 8);
+}
+
+TEST_CASE("profile: reports") {
+    profile::reset();
+
+    auto        word = named("word", +CharRng<'a', 'z'>{});
+    std::string s    = "hello";
+    InputStream<> S(s);
+    CHECK(word.parse(S).has_value());
+
+    std::ostringstream table;
+    profile::report(table);
+    CHECK(table.str().find("word") != std::string::npos);
+    CHECK(table.str().find("calls") != std::string::npos);
+
+    std::ostringstream json;
+    profile::report_json(json);
+    CHECK(json.str().find("{\"rule\": \"word\", \"calls\": 1, "
+                          "\"successes\": 1, \"failures\": 0, "
+                          "\"consumed\": 5, \"backtracked\": 0") !=
+          std::string::npos);
+}
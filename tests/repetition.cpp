@@ -0,0 +1,127 @@
+#include "catch.hpp"
+#include "cppeg.hpp"
+
+#include <type_traits>
+#include <vector>
+
+using namespace cppeg;
+
+TEST_CASE("Repetition: star and plus") {
+
+    std::string   s = "aaab";
+    InputStream<> S(s);
+
+    auto as  = *Char<'a'>;
+    auto ret = as.parse(S);
+    REQUIRE(ret.has_value());
+    CHECK((*ret == std::vector<char>{'a', 'a', 'a'}));
+
+    // star never fails
+    auto ret2 = as.parse(S);
+    REQUIRE(ret2.has_value());
+    CHECK(ret2->empty());
+
+    auto plus_a = +Char<'a'>;
+    CHECK(plus_a.parse(S).has_value() == false);
+    CHECK(S.get_pos() == 3);
+}
+
+TEST_CASE("Repetition: bounded repeat") {
+
+    std::string s = "abababab";
+
+    InputStream<> S1(s);
+    auto          two_to_three = repeat<2, 3>(Char<'a'> + Char<'b'>);
+    auto          ret          = two_to_three.parse(S1);
+    REQUIRE(ret.has_value());
+    CHECK(ret->size() == 3);
+    CHECK(S1.get_pos() == 6);
+
+    // Only one "ab" left: fails, and rewinds.
+    CHECK(two_to_three.parse(S1).has_value() == false);
+    CHECK(S1.get_pos() == 6);
+
+    InputStream<> S2(s);
+    auto          exactly_five = repeat<5>(Char<'a'> + Char<'b'>);
+    CHECK(exactly_five.parse(S2).has_value() == false);
+    CHECK(S2.get_pos() == 0);
+}
+
+TEST_CASE("Repetition: Min over a nullable subrule") {
+
+    // Once a match consumes nothing, every further one would match
+    // the same way, so the required iterations are satisfied.
+    std::string   s = "b";
+    InputStream<> S(s);
+    auto          three = repeat<3>(*Char<'a'>);
+    auto          ret   = three.parse(S);
+    REQUIRE(ret.has_value());
+    CHECK(ret->size() == 3);
+    CHECK(ret->back().empty());
+    CHECK(S.get_pos() == 0);
+
+    std::string   s2 = "aab";
+    InputStream<> S2(s2);
+    auto          ret2 = three.parse(S2);
+    REQUIRE(ret2.has_value());
+    REQUIRE(ret2->size() == 3);
+    CHECK((*ret2)[0].size() == 2);
+    CHECK((*ret2)[1].empty());
+    CHECK(S2.get_pos() == 2);
+
+    // Each item is the (zero) count of the inner repetition.
+    auto counted = repeat<2, 4>(*~Char<' '>);
+    CHECK((counted.parse(S) == std::vector<std::size_t>{0, 0}));
+}
+
+TEST_CASE("Repetition: discarded subrules yield a count") {
+
+    std::string   s = "   x";
+    InputStream<> S(s);
+
+    auto spaces = *~Char<' '>;
+    auto ret    = spaces.parse(S);
+    CHECK((std::is_same_v<decltype(ret), std::optional<std::size_t>>));
+    REQUIRE(ret.has_value());
+    CHECK(*ret == 3);
+}
+
+TEST_CASE("Repetition: empty matches do not loop forever") {
+
+    std::string   s = "b";
+    InputStream<> S(s);
+
+    auto empties = *(*Char<'a'>);
+    auto ret     = empties.parse(S);
+    REQUIRE(ret.has_value());
+    CHECK(ret->size() == 1);
+}
+
+TEST_CASE("Repetition: into() reuses the caller's container") {
+
+    std::vector<char> sink;
+    sink.reserve(16);
+    auto capacity = sink.capacity();
+
+    auto digits = (+CharRng<'0', '9'>{}).into(sink);
+
+    std::string   s1 = "123";
+    InputStream<> S1(s1);
+    auto          n = digits.parse(S1);
+    REQUIRE(n.has_value());
+    CHECK(*n == 3);
+    CHECK((sink == std::vector<char>{'1', '2', '3'}));
+
+    sink.clear();
+    std::string   s2 = "4567x";
+    InputStream<> S2(s2);
+    CHECK(digits.parse(S2).value() == 4);
+    CHECK((sink == std::vector<char>{'4', '5', '6', '7'}));
+    CHECK(sink.capacity() == capacity);
+
+    // A failed parse leaves the sink alone.
+    auto three = repeat<3>(CharRng<'0', '9'>{}).into(sink);
+    InputStream<> S3(std::string_view("12"));
+    CHECK(three.parse(S3).has_value() == false);
+    CHECK(sink.size() == 4);
+}
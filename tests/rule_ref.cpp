@@ -0,0 +1,105 @@
+#include "catch.hpp"
+#include "cppeg.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace cppeg;
+
+TEST_CASE("RuleRef: used before define() fails to match") {
+
+    RuleRef<int> undefined;
+    CHECK(undefined.defined() == false);
+
+    std::string   s = "x";
+    InputStream<> S(s);
+
+    // The debug assertion goes to std::cerr; keep it off the test output.
+    std::ostringstream err;
+    auto *             old = std::cerr.rdbuf(err.rdbuf());
+    auto               ret = undefined.parse(S);
+    std::cerr.rdbuf(old);
+
+    CHECK(ret.has_value() == false);
+    CHECK(S.get_pos() == 0);
+#ifndef NDEBUG
+    CHECK(err.str().find("RuleRef used before define()") != std::string::npos);
+#endif
+}
+
+TEST_CASE("RuleRef: nested parentheses") {
+
+    auto deeper = [](auto const &t) { return std::get<1>(*t) + 1; };
+    auto leaf   = [](auto const &) { return 0; };
+
+    RuleRef<int> nest;
+    auto &top = nest.define((Char<'('> + nest + Char<')'>)[deeper] |
+                            Char<'x'>[leaf]);
+    CHECK(nest.defined());
+
+    std::string s = "(((x)))";
+    {
+        InputStream<> S(s);
+        CHECK(nest.parse(S) == 3);
+        CHECK(S.get_pos() == 7);
+    }
+    {
+        // The typed definition parses the same, without the handle.
+        InputStream<> S(s);
+        auto          ret = top.parse(S);
+        CHECK(std::get<1>(ret) == 3);
+    }
+    {
+        std::string   bad = "((x)";
+        InputStream<> S(bad);
+        CHECK(nest.parse(S).has_value() == false);
+        CHECK(S.get_pos() == 0);
+    }
+}
+
+TEST_CASE("RuleRef: mutually recursive lists") {
+
+    // value := digit | '[' list ']'
+    // list  := value (',' value)*
+    RuleRef<long> value;
+    RuleRef<long> list;
+
+    auto to_long = [](auto const &c) { return static_cast<long>(*c - '0'); };
+    auto inner   = [](auto const &t) { return std::get<1>(*t); };
+    auto add_all = [](auto const &t) {
+        auto [first, rest] = *t;
+        for (auto v : rest) {
+            first += std::get<0>(v); // the discarded comma is dropped
+        }
+        return first;
+    };
+
+    auto digit     = CharRng<'0', '9'>{}[to_long];
+    auto bracketed = (Char<'['> + list + Char<']'>)[inner];
+    auto sum       = (value + *(~Char<','> + value))[add_all];
+    value.define(digit | bracketed);
+    list.define(sum);
+
+    std::string   s = "[1,[2,3],[[4]],5]";
+    InputStream<> S(s);
+    CHECK(value.parse(S) == 15);
+    CHECK(S.get_pos() == s.size());
+}
+
+TEST_CASE("RuleRef: copies refer to the original") {
+
+    RuleRef<char> r;
+    auto          copy = r; // before definition
+    r.define(Char<'a'>);
+
+    std::string   s = "a";
+    InputStream<> S(s);
+    CHECK(copy.defined());
+    CHECK(copy.id() == r.id());
+    CHECK(copy.parse(S) == 'a');
+
+    RuleRef<char> moved = std::move(r);
+    CHECK(moved.id() == copy.id());
+}
@@ -0,0 +1,75 @@
+#include "catch.hpp"
+#include "cppeg.hpp"
+
+using namespace cppeg;
+
+TEST_CASE("Skip policy: runtime flag is the default") {
+
+    std::string   s = "a b";
+    InputStream<> S(s);
+    CHECK(S.get_ignore_state() == false);
+
+    auto ab = Char<'a'> + Char<'b'>;
+    CHECK(ab.parse(S).has_value() == false);
+
+    S.set_ignore_state(true);
+    CHECK(ab.parse(S).has_value());
+}
+
+TEST_CASE("Skip policy: compile-time policies") {
+
+    std::string s = " a \n b";
+    auto        ab = Char<'a'> + Char<'b'>;
+
+    InputStream<char, NoSkip> S1(s);
+    CHECK(ab.parse(S1).has_value() == false);
+    CHECK(S1.getChar() == ' ');
+
+    InputStream<char, SkipWhitespace> S2(s);
+    CHECK(ab.parse(S2).has_value());
+    CHECK(S2.distance_to_end() == 0);
+}
+
+TEST_CASE("Skip policy: user-supplied skipper rule") {
+
+    // '#' stands in for a comment marker here.
+    std::string s    = "#a # #b#";
+    auto        skip = skip_with(AnyChar<' ', '#'>{});
+    auto        ab   = Char<'a'> + Char<'b'>;
+
+    InputStream<char, decltype(skip)> S(s, skip);
+    CHECK(ab.parse(S).has_value());
+    CHECK(S.peekChar() == char(-1));
+    CHECK(S.distance_to_end() == 0);
+}
+
+TEST_CASE("Skip policy: skipper rule shared by streams") {
+
+    // Packrat tables live in the policy's context, which each stream
+    // gets its own copy of.
+    auto skip = skip_with(packrat(AnyChar<' ', '#'>{}));
+    auto ab   = Char<'a'> + Char<'b'>;
+
+    std::string s1 = "  a b", s2 = "##ab#";
+    InputStream<char, decltype(skip)> S1(s1, skip), S2(s2, skip);
+    CHECK(ab.parse(S1).has_value());
+    CHECK(ab.parse(S2).has_value());
+    CHECK(S1.distance_to_end() == 0);
+    CHECK(S2.peekChar() == char(-1));
+
+    // Skipping again from earlier positions reuses the tables.
+    S1.restore(0);
+    CHECK(S1.peekChar() == 'a');
+    CHECK(S1.get_pos() == 2);
+}
+
+TEST_CASE("Skip policy: skipper rule over wide chars") {
+
+    auto skip = skip_with<wchar_t>(AnyChar<' ', '#'>{});
+    auto ab   = Char<'a'> + Char<'b'>;
+
+    std::wstring                         s = L" #a# b ";
+    InputStream<wchar_t, decltype(skip)> S(s, skip);
+    CHECK(ab.parse(S).has_value());
+    CHECK(S.peekChar() == wchar_t(-1));
+}
@@ -0,0 +1,69 @@
+#include "catch.hpp"
+#include "cppeg.hpp"
+
+#include <type_traits>
+
+using namespace cppeg;
+
+TEST_CASE("StaticLiteral: grammar object is empty") {
+
+    using get_t = StaticLiteral<'G', 'E', 'T'>;
+    CHECK(std::is_empty_v<get_t>);
+    CHECK(std::is_trivially_copyable_v<get_t>);
+    CHECK((std::is_same_v<std::decay_t<decltype("GET"_lit)>, get_t>));
+}
+
+TEST_CASE("StaticLiteral: match and failure") {
+
+    std::string   s = "GET /index.html";
+    InputStream<> S(s, true);
+
+    auto get  = "GET"_lit;
+    auto post = Lit<'P', 'O', 'S', 'T'>;
+
+    auto fail = post.parse(S);
+    CHECK(fail.has_value() == false);
+    CHECK(S.get_pos() == 0);
+
+    auto ret = get.parse(S);
+    REQUIRE(ret.has_value());
+    CHECK(*ret == "GET");
+    CHECK(S.get_pos() == 3);
+
+    auto path = "/index.html"_lit;
+    CHECK(path.parse(S).has_value());
+    CHECK(S.distance_to_end() == 0);
+
+    // Input shorter than the literal
+    CHECK(get.parse(S).has_value() == false);
+}
+
+TEST_CASE("StaticLiteral: in sequences") {
+
+    std::string   s = "abba";
+    InputStream<> S(s);
+
+    auto parser = Char<'a'> + "bb"_lit + Char<'a'>;
+    auto ret    = parser.parse(S);
+    CHECK(ret.has_value());
+    CHECK(std::get<1>(ret.value()) == "bb");
+}
+
+TEST_CASE("StaticLiteral: wide streams") {
+
+    std::wstring         s = L"GET /";
+    InputStream<wchar_t> S(s, true);
+
+    auto ret = ("GET"_lit + Lit<'/'>).parse(S);
+    REQUIRE(ret.has_value());
+    CHECK((std::is_same_v<decltype(ret),
+                          std::optional<std::tuple<std::wstring_view,
+                                                   std::wstring_view>>>));
+    CHECK(std::get<0>(*ret) == L"GET");
+    CHECK(std::get<1>(*ret) == L"/");
+    CHECK(S.distance_to_end() == 0);
+
+    S.restore(0);
+    CHECK("POST"_lit.parse(S).has_value() == false);
+    CHECK(S.get_pos() == 0);
+}
@@ -0,0 +1,175 @@
+#include "catch.hpp"
+#include "cppeg.hpp"
+
+#include <unistd.h>
+
+using namespace cppeg;
+
+namespace {
+// Reader that hands out the string a few chars at a time.
+auto string_reader(std::string const &s, std::size_t max_read) {
+    return [s, max_read, off = std::size_t{0}](char *dst,
+                                               std::size_t n) mutable {
+        auto len = std::min({n, max_read, s.size() - off});
+        std::copy_n(s.data() + off, len, dst);
+        off += len;
+        return len;
+    };
+}
+} // namespace
+
+TEST_CASE("StreamingInputStream: parse across chunk boundaries") {
+
+    StreamingInputStream<> S(string_reader("abba", 1), false, 1);
+
+    auto parser = Char<'a'> + "bb"_L + Char<'a'>;
+    auto ret    = parser.parse(S);
+
+    auto answer = std::tuple<char, std::string, char>('a', "bb", 'a');
+    CHECK(ret.has_value());
+    CHECK(ret.value() == answer);
+    CHECK(S.at_end());
+}
+
+TEST_CASE("StreamingInputStream: backtracking within the window") {
+
+    StreamingInputStream<> S(string_reader("abcabd", 2), false, 2);
+
+    auto abc = Char<'a'> + Char<'b'> + Char<'c'>;
+    auto abd = Char<'a'> + Char<'b'> + Char<'d'>;
+
+    CHECK(abc.parse(S).has_value());
+    CHECK(S.get_pos() == 3);
+
+    CHECK(abc.parse(S).has_value() == false);
+    CHECK(S.get_pos() == 3);
+    CHECK(abd.parse(S).has_value());
+    CHECK(S.get_pos() == 6);
+}
+
+TEST_CASE("StreamingInputStream: memory stays bounded") {
+
+    std::string input;
+    for (int i = 0; i < 10000; ++i) {
+        input += "abba";
+    }
+
+    constexpr std::size_t  chunk = 16;
+    StreamingInputStream<> S(string_reader(input, chunk), false, chunk);
+
+    auto        record  = Char<'a'> + "bb"_L + Char<'a'>;
+    std::size_t count   = 0;
+    std::size_t max_buf = 0;
+    while (record.parse(S).has_value()) {
+        ++count;
+        max_buf = std::max(max_buf, S.buffered());
+    }
+
+    CHECK(count == 10000);
+    CHECK(S.at_end());
+    CHECK(max_buf <= 2 * chunk);
+}
+
+TEST_CASE("StreamingInputStream: read from a pipe") {
+
+    int fds[2];
+    REQUIRE(::pipe(fds) == 0);
+    std::string text = "a bb a";
+    REQUIRE(::write(fds[1], text.data(), text.size()) ==
+            static_cast<ssize_t>(text.size()));
+    ::close(fds[1]);
+
+    StreamingInputStream<> S(fds[0], true);
+    auto parser = Char<'a'> + "bb"_L + Char<'a'>;
+    CHECK(parser.parse(S).has_value());
+    ::close(fds[0]);
+}
+
+TEST_CASE("StreamingInputStream: results outlive later reads") {
+
+    // With a chunk size of 1 every char is a refill, which moves the
+    // buffer under anything still pointing into it.
+    {
+        StreamingInputStream<> S(string_reader("aab", 1), false, 1);
+        auto parser = span(+Char<'a'>) + Char<'b'>;
+        auto ret    = parser.parse(S);
+        REQUIRE(ret.has_value());
+        CHECK(std::get<0>(ret.value()) == "aa");
+        CHECK(std::get<1>(ret.value()) == 'b');
+    }
+    {
+        StreamingInputStream<> S(string_reader("abc", 1), false, 1);
+        auto parser = "ab"_Lv + Char<'c'>;
+        auto ret    = parser.parse(S);
+        REQUIRE(ret.has_value());
+        CHECK(std::get<0>(ret.value()) == "ab");
+    }
+    {
+        StreamingInputStream<> S(string_reader("insert!", 1), false, 1);
+        auto parser = ("in"_L | "insert"_L) + Char<'s'> + "ert!"_L;
+        auto ret    = parser.parse(S);
+        REQUIRE(ret.has_value());
+        CHECK(std::get<0>(ret.value()).span == "in");
+    }
+}
+
+TEST_CASE("StreamingInputStream: skip policies") {
+
+    auto parser = Char<'a'> + "bb"_L + Char<'a'>;
+    {
+        // Whitespace runs longer than a chunk.
+        StreamingInputStream<char, SkipWhitespace> S(
+            string_reader("a    bb \n\n\t a", 2), SkipWhitespace{}, 2);
+        CHECK(parser.parse(S).has_value());
+        CHECK(S.at_end());
+    }
+    {
+        StreamingInputStream<char, NoSkip> S(string_reader("a bba", 2),
+                                             NoSkip{}, 2);
+        CHECK(parser.parse(S).has_value() == false);
+        CHECK(S.get_pos() == 0);
+    }
+    {
+        // Comments split across refills, and ended by the last one.
+        auto comment = "/*"_lit + *(Char<'x'> | Char<'y'>) + "*/"_lit;
+        auto ws      = Char<' '> | comment;
+        using Stream = StreamingInputStream<char, SkipRule<decltype(ws)>>;
+
+        Stream S(string_reader("a/*xyx*/ bb /*yy*/a/**/", 1), skip_with(ws),
+                 1);
+        CHECK(parser.parse(S).has_value());
+        CHECK(S.get_pos() == 19);
+        CHECK(S.at_end() == false);
+        S.peekChar(); // skips the last comment
+        CHECK(S.at_end());
+    }
+}
+
+TEST_CASE("StreamingInputStream: parse errors") {
+
+    // Records on lines of their own; the third one is bad.
+    auto record = Char<'a'> + "bb"_L + Char<'a'> + Char<'\n'>;
+
+    StreamingInputStream<> S(string_reader("abba\nabba\nabca\n", 1), false,
+                             1);
+    S.context().failures().enable();
+    std::size_t count = 0;
+    while (record.parse(S).has_value()) {
+        ++count;
+    }
+    CHECK(count == 2);
+
+    auto e = parse_error(S);
+    CHECK(e.offset == 11);
+    CHECK(e.line == 3);
+    CHECK(e.column == 2);
+    CHECK(e.message() == "line 3, column 2: expected literal");
+
+    // Without tracking, the error is where the parse stopped, past
+    // the whitespace skipped there.
+    auto word = Char<'a'> + "bb"_L + Char<'a'>;
+    StreamingInputStream<> T(string_reader("abba\n  x", 1), true, 1);
+    CHECK(word.parse(T).has_value());
+    CHECK(word.parse(T).has_value() == false);
+    CHECK(parse_error(T).message() == "line 2, column 3: syntax error");
+}
@@ -0,0 +1,163 @@
+#include "catch.hpp"
+#include "cppeg.hpp"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cppeg;
+
+TEST_CASE("Symbols: longest match returns the value") {
+
+    Symbols<int> sym{{"in", 1}, {"int", 2}, {"integer", 3}, {"float", 4}};
+    CHECK(sym.size() == 4);
+
+    std::string   s = "integerintfloatinx";
+    InputStream<> S(s);
+
+    CHECK(sym.parse(S) == 3);
+    CHECK(sym.parse(S) == 2);
+    CHECK(sym.parse(S) == 4);
+    CHECK(sym.parse(S) == 1);
+    CHECK(S.get_pos() == 17);
+
+    CHECK(sym.parse(S).has_value() == false);
+    CHECK(S.get_pos() == 17);
+}
+
+TEST_CASE("Symbols: add and remove at runtime, seen by copies") {
+
+    Symbols<std::string> hosts;
+    auto                 rule = hosts + Char<';'>;
+
+    std::string s = "example.org;";
+    {
+        InputStream<> S(s);
+        CHECK(rule.parse(S).has_value() == false);
+    }
+
+    CHECK(hosts.add("example.org", "93.184.216.34"));
+    CHECK_FALSE(hosts.add("example.org", "other"));
+    CHECK(hosts.add("example.com", "93.184.216.35"));
+    {
+        InputStream<> S(s);
+        auto          ret = rule.parse(S);
+        REQUIRE(ret.has_value());
+        CHECK(std::get<0>(*ret) == "93.184.216.34");
+    }
+
+    CHECK(hosts.remove("example.org"));
+    CHECK_FALSE(hosts.remove("example.org"));
+    CHECK(hosts.find("example.org") == nullptr);
+    REQUIRE(hosts.find("example.com") != nullptr);
+    CHECK(*hosts.find("example.com") == "93.184.216.35");
+    {
+        InputStream<> S(s);
+        CHECK(rule.parse(S).has_value() == false);
+    }
+}
+
+TEST_CASE("Symbols: edge splits and merges") {
+
+    Symbols<int> sym;
+    sym.add("abcd", 1);
+    sym.add("ab", 2);   // splits "abcd"
+    sym.add("abxy", 3); // splits again below "ab"
+    sym.add("", 0);
+
+    CHECK(*sym.find("ab") == 2);
+    CHECK(sym.find("abc") == nullptr);
+    CHECK(sym.find("a") == nullptr);
+
+    CHECK(sym.remove("ab")); // "ab" node stays, two children
+    CHECK(sym.find("ab") == nullptr);
+    CHECK(*sym.find("abcd") == 1);
+    CHECK(sym.remove("abxy")); // "ab" merges into "abcd"
+    CHECK(*sym.find("abcd") == 1);
+    CHECK(sym.size() == 2);
+
+    std::string   s = "abcz";
+    InputStream<> S(s);
+    CHECK(sym.parse(S) == 0); // only the empty key matches
+    CHECK(S.get_pos() == 0);
+
+    sym.add("abc", 5);
+    CHECK(sym.parse(S) == 5);
+}
+
+TEST_CASE("Symbols: repeated add and remove reuse the flat arrays") {
+
+    // Growing edge ranges and merged labels leave gaps that are
+    // compacted away; the table must read the same afterwards.
+    Symbols<int> sym;
+    for (int round = 0; round < 50; ++round) {
+        for (int i = 0; i < 40; ++i) {
+            CHECK(sym.add("k" + std::to_string(i), i));
+        }
+        for (int i = 0; i < 40; i += 2) {
+            CHECK(sym.remove("k" + std::to_string(i)));
+        }
+        for (int i = 1; i < 40; i += 2) {
+            CHECK(*sym.find("k" + std::to_string(i)) == i);
+        }
+        for (int i = 1; i < 40; i += 2) {
+            CHECK(sym.remove("k" + std::to_string(i)));
+        }
+        CHECK(sym.size() == 0);
+    }
+
+    sym.add("key", 1);
+    sym.add("keys", 2);
+    std::string   s = "keys";
+    InputStream<> S(s);
+    CHECK(sym.parse(S) == 2);
+}
+
+TEST_CASE("Symbols: concurrent read-only parsing") {
+
+    Symbols<int> sym;
+    std::string  text;
+    for (int i = 0; i < 100; ++i) {
+        auto key = "sym" + std::to_string(i) + ";";
+        sym.add(key, i);
+        text += key;
+    }
+
+    auto all = *sym;
+    std::vector<std::thread> threads;
+    std::vector<long>        sums(4);
+    for (std::size_t t = 0; t < sums.size(); ++t) {
+        threads.emplace_back([&, t] {
+            auto          rule = all;
+            InputStream<> S(text);
+            auto          values = rule.parse(S);
+            for (int v : *values) {
+                sums[t] += v;
+            }
+        });
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+    for (auto sum : sums) {
+        CHECK(sum == 4950);
+    }
+}
+
+TEST_CASE("Symbols: wide keys on wide streams") {
+
+    Symbols<int, wchar_t> sym{{L"in", 1}, {L"int", 2}, {L"ïntegér", 3}};
+    sym.add(L"中文", 4);
+    CHECK(sym.find(L"int") != nullptr);
+
+    std::wstring         s = L"ïntegér 中文 int";
+    InputStream<wchar_t> S(s, true);
+
+    CHECK(sym.parse(S) == 3);
+    CHECK(sym.parse(S) == 4);
+    CHECK(sym.parse(S) == 2);
+    CHECK(sym.parse(S).has_value() == false);
+
+    CHECK(sym.remove(L"in"));
+    CHECK(sym.size() == 3);
+}
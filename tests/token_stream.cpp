@@ -0,0 +1,163 @@
+#include "catch.hpp"
+#include "cppeg.hpp"
+
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace cppeg;
+
+namespace {
+
+enum class Kind { let, ident, number, eq, plus, minus, semi };
+
+auto make_lexer() {
+    using lower = CharRng<'a', 'z'>;
+    using digit = CharRng<'0', '9'>;
+    return lexer(AnyChar<' ', '\t', '\n'>{},
+                 token<Kind::let>(Lit<'l', 'e', 't'>),
+                 token<Kind::ident>(CharClass<lower>{} + *CharClass<lower, digit>{}),
+                 token<Kind::number>(+digit{}),
+                 token<Kind::eq>(Char<'='>),
+                 token<Kind::plus>(Char<'+'>),
+                 token<Kind::minus>(Char<'-'>),
+                 token<Kind::semi>(Char<';'>));
+}
+
+std::vector<Kind> kinds(std::vector<Token> const &tokens) {
+    std::vector<Kind> ret;
+    for (auto const &t : tokens) {
+        ret.push_back(static_cast<Kind>(t.kind));
+    }
+    return ret;
+}
+
+} // namespace
+
+TEST_CASE("Lexer: longest match, first definition on ties") {
+
+    auto lex = make_lexer();
+
+    std::string        s = "let letter = x1 +42;";
+    std::vector<Token> tokens;
+    CHECK(lex.tokenize(s, tokens) == s.size());
+    CHECK((kinds(tokens) == std::vector<Kind>{Kind::let, Kind::ident, Kind::eq,
+                                              Kind::ident, Kind::plus,
+                                              Kind::number, Kind::semi}));
+    CHECK(tokens[1].offset == 4);
+    CHECK(tokens[1].length == 6);
+
+    TokenStream S(s, tokens);
+    CHECK(S.text(tokens[5]) == "42");
+}
+
+TEST_CASE("Lexer: stops at text that starts no token") {
+
+    auto lex = make_lexer();
+
+    std::string        s = "a = b ? c";
+    std::vector<Token> tokens;
+    CHECK(lex.tokenize(s, tokens) == 6);
+    CHECK(tokens.size() == 3);
+
+    // Without a skip rule, tokens must be adjacent.
+    auto tight = lexer(token<0>(+CharRng<'a', 'z'>{}), token<1>(Char<','>));
+    CHECK(tight.tokenize("ab,c").size() == 3);
+    CHECK(tight.tokenize("ab, c").size() == 2);
+
+    // Text too long for 32-bit offsets is an error, not a lex failure
+    // at 0. tokenize() checks the length with check_text_size() before
+    // reading anything; no such text is built here.
+    using lexer_type = decltype(lex);
+    static_assert(lexer_type::max_text_size ==
+                  std::numeric_limits<std::uint32_t>::max());
+    CHECK_NOTHROW(lexer_type::check_text_size(lexer_type::max_text_size));
+    CHECK_THROWS_AS(lexer_type::check_text_size(lexer_type::max_text_size + 1),
+                    std::length_error const &);
+}
+
+TEST_CASE("TokenStream: combinators over tokens") {
+
+    auto        lex = make_lexer();
+    std::string s   = "let x = 1 + y - 20;\nlet y = 3;";
+    auto        tokens = lex.tokenize(s);
+
+    auto to_long = [](auto const &v) { return std::stol(std::string(*v)); };
+    auto unbound = [](auto const &) { return 0L; };
+    auto value   = Tok<Kind::number>[to_long] | Tok<Kind::ident>[unbound];
+
+    auto op  = Tok<Kind::plus> | Tok<Kind::minus>;
+    auto sum = [](auto const &t) {
+        auto [first, rest] = *t;
+        long v = std::get<long>(first);
+        for (auto const &[o, term] : rest) {
+            bool plus = std::get<std::string_view>(o) == "+";
+            v += plus ? std::get<long>(term) : -std::get<long>(term);
+        }
+        return v;
+    };
+    auto expr = (value + *(op + value))[sum];
+    auto stmt = ~Tok<Kind::let> + Tok<Kind::ident> + ~Tok<Kind::eq> + expr +
+                ~Tok<Kind::semi>;
+
+    TokenStream S(s, tokens);
+    auto        first = stmt.parse(S);
+    REQUIRE(first.has_value());
+    CHECK(std::get<0>(*first) == "x");
+    CHECK(std::get<1>(*first) == -19);
+    CHECK(S.get_pos() == 9);
+
+    // span() covers the source text of the matched tokens.
+    auto before = S.get_pos();
+    auto second = span(stmt).parse(S);
+    REQUIRE(second.has_value());
+    CHECK(*second == "let y = 3;");
+    CHECK(S.span(before, S.get_pos()) == "let y = 3;");
+    CHECK(S.at_end());
+    CHECK(S.peekChar().kind == Token::end_kind);
+}
+
+TEST_CASE("TokenStream: failed alternatives rewind to the token") {
+
+    auto        lex    = make_lexer();
+    std::string s      = "a = b c";
+    auto        tokens = lex.tokenize(s);
+
+    auto assign = Tok<Kind::ident> + Tok<Kind::eq> + Tok<Kind::ident> +
+                  Tok<Kind::semi>;
+    auto pair = Tok<Kind::ident> + Tok<Kind::eq> + Tok<Kind::ident> +
+                Tok<Kind::ident>;
+
+    TokenStream S(s, tokens);
+    auto        ret = (assign | pair).parse(S);
+    REQUIRE(ret.index() == 1); // both alternatives yield the same type
+    CHECK(std::get<3>(std::get<1>(ret)) == "c");
+    CHECK(S.at_end());
+
+    TokenStream T(s, tokens);
+    CHECK(assign.parse(T).has_value() == false);
+    CHECK(T.get_pos() == 0);
+}
+
+TEST_CASE("TokenStream: memoized and recursive rules") {
+
+    // list := ident (',' list)?  -- as a RuleRef, memoized.
+    auto lex = lexer(AnyChar<' '>{}, token<0>(+CharRng<'a', 'z'>{}),
+                     token<1>(Char<','>));
+    std::string s      = "a, b, c, d";
+    auto        tokens = lex.tokenize(s);
+
+    RuleRef<std::size_t, TokenStream> list;
+    auto count = [](auto const &t) {
+        auto const &rest = std::get<1>(*t);
+        return 1 + (rest.empty() ? 0 : std::get<1>(rest[0]));
+    };
+    list.define((Tok<0> + repeat<0, 1>(Tok<1> + list))[count]);
+
+    TokenStream S(s, tokens);
+    auto        ret = memo(list).parse(S);
+    REQUIRE(ret.has_value());
+    CHECK(*ret == 4);
+    CHECK(S.at_end());
+}
@@ -0,0 +1,58 @@
+#include "catch.hpp"
+#include "cppeg.hpp"
+
+#include <cctype>
+#include <string>
+
+using namespace cppeg;
+
+namespace {
+std::size_t reference_skip(std::string const &s, std::size_t pos) {
+    while (pos < s.size() && std::isspace(static_cast<unsigned char>(s[pos]))) {
+        ++pos;
+    }
+    return pos;
+}
+} // namespace
+
+TEST_CASE("ASCII whitespace table matches std::isspace") {
+    for (int c = 0; c < 128; ++c) {
+        CHECK(detail::ascii_space_table[c] == (std::isspace(c) != 0));
+    }
+    for (int c = 128; c < 256; ++c) {
+        CHECK(detail::ascii_space_table[c] == false);
+    }
+}
+
+TEST_CASE("Whitespace skip: runs of every length") {
+    std::string const spaces = " \t\n\v\f\r";
+    for (std::size_t len = 0; len < 100; ++len) {
+        for (char stop : {'x', '\0', '\x80', '\xff', '\x08', '\x0e'}) {
+            std::string s = "a";
+            for (std::size_t i = 0; i < len; ++i) {
+                s += spaces[i % spaces.size()];
+            }
+            s += stop;
+            s += "  ";
+
+            auto got = detail::skip_ascii_whitespace(std::string_view(s), 1);
+            CHECK(got == reference_skip(s, 1));
+        }
+    }
+}
+
+TEST_CASE("Whitespace skip: run reaching end of input") {
+    std::string s(70, ' ');
+    CHECK(detail::skip_ascii_whitespace(std::string_view(s), 0) == s.size());
+    CHECK(detail::skip_ascii_whitespace(std::string_view(s), s.size()) ==
+          s.size());
+}
+
+TEST_CASE("Whitespace skip: InputStream ignores long indentation") {
+    std::string   s = "{\n" + std::string(200, ' ') + "a\n\t\t}";
+    InputStream<> S(s, true);
+
+    auto parser = Char<'{'> + Char<'a'> + Char<'}'>;
+    CHECK(parser.parse(S).has_value());
+    CHECK(S.distance_to_end() == 0);
+}
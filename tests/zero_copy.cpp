@@ -0,0 +1,104 @@
+#include "catch.hpp"
+#include "cppeg.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace cppeg;
+
+// Count every heap allocation made by the test binary (which is why
+// these tests have an executable of their own). Only the difference
+// across a parse call is looked at.
+static std::atomic<std::size_t> g_allocations{0};
+
+void *operator new(std::size_t n) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(n ? n : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+static std::size_t allocations() {
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+TEST_CASE("Zero copy: LiteralView returns a view into the input") {
+
+    std::string   s = "select";
+    InputStream<> S(s);
+
+    auto kw  = "select"_Lv;
+    auto ret = kw.parse(S);
+    CHECK(ret.has_value());
+    CHECK(*ret == "select");
+    CHECK(ret->data() == s.data());
+}
+
+TEST_CASE("Zero copy: span of a compound rule") {
+
+    std::string   s = "  abba!";
+    InputStream<> S(s, true);
+
+    auto parser = span(Char<'a'> + "bb"_L + Char<'a'>);
+    auto ret    = parser.parse(S);
+
+    bool is_view = std::is_same_v<std::decay_t<decltype(ret)>,
+                                  std::optional<std::string_view>>;
+    CHECK(is_view);
+    CHECK(ret.has_value());
+    CHECK(*ret == "abba");
+    CHECK(ret->data() == s.data() + 2);
+
+    auto fail = span(Char<'x'> + Char<'y'>);
+    CHECK(fail.parse(S).has_value() == false);
+    CHECK(S.get_pos() == 6);
+}
+
+TEST_CASE("Zero copy: keyword grammar does not allocate") {
+
+    std::string   s = "transaction_isolation_level serializable;";
+    InputStream<> S(s, true);
+
+    auto copying = "transaction_isolation_level"_L + "serializable"_L;
+    auto viewing = "transaction_isolation_level"_Lv + "serializable"_Lv +
+                   span(Char<';'>);
+
+    auto before = allocations();
+    auto ret1   = copying.parse(S);
+    CHECK(allocations() > before); // beyond the small-string buffer
+    CHECK(ret1.has_value());
+
+    S.restore(0);
+    before    = allocations();
+    auto ret2 = viewing.parse(S);
+    auto after = allocations();
+    CHECK(after == before);
+    REQUIRE(ret2.has_value());
+    CHECK(std::get<0>(*ret2) == "transaction_isolation_level");
+    CHECK(std::get<2>(*ret2) == ";");
+}
+
+TEST_CASE("Zero copy: recursion through RuleRef does not allocate") {
+
+    auto deeper = [](auto const &t) { return std::get<1>(*t) + 1; };
+    auto leaf   = [](auto const &) { return 0; };
+
+    RuleRef<int> nest;
+    nest.define((Char<'('> + nest + Char<')'>)[deeper] | Char<'x'>[leaf]);
+
+    std::string   s(50, '(');
+    s += 'x';
+    s += std::string(50, ')');
+    InputStream<> S(s);
+
+    auto before = allocations();
+    auto ret    = nest.parse(S);
+    auto after  = allocations();
+    CHECK(after == before);
+    CHECK(ret == 50);
+}